@@ -0,0 +1,389 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "batch.cpp" - Member functions of class "batchSolver" (defined in "batch.h").                   *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "batch.h"
+#include "workpool.h"
+
+using namespace std;
+
+/*
+ * Return 'name' prefixed with directory 'dir' unless it is absolute.
+ */
+static string joinPath(const string &dir, const string &name) {
+   if (dir.empty() || name.empty() || name[0] == '/' || name[0] == '\\'
+       || (name.size() > 1 && name[1] == ':'))
+     return name;
+   return dir + "/" + name;
+}
+
+/*
+ * Return 'text' as a quoted CSV field, quotes in it doubled.
+ */
+static string csvField(const string &text) {
+   string field = "\"";
+   for (size_t i = 0; i < text.size(); ++i) {
+      if (text[i] == '"')
+        field += '"';
+      field += text[i];
+   }
+   return field + "\"";
+}
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Constructor.
+ */
+batchSolver::batchSolver(void) {
+   workers   = workStealingPool::hardwareThreads();
+   loads     = 0;
+   uses      = 0;
+   timeTaken = 0;
+}
+
+/*
+ * Destructor.
+ */
+batchSolver::~batchSolver(void) {
+   for (int i = 0; i < (int)puzzles.size(); ++i) {
+      delete puzzles[i]->puz;
+      delete puzzles[i];
+   }
+}
+
+/*
+ * Read jobs from manifest 'fileName'.
+ */
+bool batchSolver::readManifest(const char *fileName, string &error) {
+   ifstream file(fileName);
+   if (!file) {
+      error = string("cannot read \"") + fileName + "\"";
+      return false;
+   }
+   string name(fileName);
+   size_t slash = name.find_last_of("/\\");
+   manifestDir = slash == string::npos ? "" : name.substr(0, slash);
+
+   jobs.clear();
+   string line;
+   for (int n = 1; getline(file, line); ++n) {
+      if (!line.empty() && line[line.size() - 1] == '\r')
+        line.erase(line.size() - 1); // file written on Windows
+      size_t first = line.find_first_not_of(" \t");
+      if (first == string::npos || line[first] == ';')
+        continue;
+      batchJob job;
+      job.line = n;
+      if (!parseJob(line, job, error)) {
+         ostringstream message;
+         message << fileName << ":" << n << ": " << error;
+         error = message.str();
+         return false;
+      }
+      for (int i = 0; i < (int)jobs.size(); ++i)
+        if (jobs[i].name == job.name) {
+           ostringstream message;
+           message << fileName << ":" << n << ": job \"" << job.name
+                   << "\" already given on line " << jobs[i].line;
+           error = message.str();
+           return false;
+        }
+      jobs.push_back(job);
+   }
+   return true;
+}
+
+/*
+ * Run every job and write the summary.
+ */
+int batchSolver::run(void) {
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   results.assign(jobs.size(), batchResult());
+   loads = 0;
+   uses  = 0;
+
+   if (!outputDir.empty()) {
+#if defined(_WIN32)
+      _mkdir(outputDir.c_str());
+#else
+      mkdir(outputDir.c_str(), 0777);
+#endif
+   }
+
+   // group jobs sharing a block set and board (keeping manifest order within each)
+   vector<int> order(jobs.size());
+   for (int i = 0; i < (int)jobs.size(); ++i)
+     order[i] = i;
+   stable_sort(order.begin(), order.end(), [this](int a, int b) {
+      return jobs[a].blockFile != jobs[b].blockFile ? jobs[a].blockFile < jobs[b].blockFile
+                                                    : jobs[a].boardFile < jobs[b].boardFile;
+   });
+
+   // cut each group into tasks of at most BATCH_CHUNK_JOBS jobs (fewer if
+   // there are too few jobs to keep every worker busy otherwise)
+   int chunkJobs = (int)jobs.size() / workers;
+   chunkJobs = chunkJobs < 1 ? 1 : chunkJobs > BATCH_CHUNK_JOBS ? BATCH_CHUNK_JOBS : chunkJobs;
+   vector<vector<int> > chunks;
+   for (int i = 0; i < (int)order.size(); ++i) {
+      const batchJob &job = jobs[order[i]];
+      if (chunks.empty() || (int)chunks.back().size() == chunkJobs
+          || jobs[chunks.back()[0]].blockFile != job.blockFile
+          || jobs[chunks.back()[0]].boardFile != job.boardFile)
+        chunks.push_back(vector<int>());
+      chunks.back().push_back(order[i]);
+   }
+
+   workStealingPool pool(workers < (int)chunks.size() ? workers : (int)chunks.size());
+   for (int i = 0; i < (int)chunks.size(); ++i)
+     pool.add(bind(&batchSolver::runChunk, this, cref(chunks[i])));
+   pool.start();
+   pool.join();
+
+   int failed = 0;
+   for (int i = 0; i < (int)results.size(); ++i)
+     if (!results[i].ok)
+       ++failed;
+   if (!writeSummary())
+     ++failed;
+   timeTaken = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+   return failed;
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Read job from manifest line 'line'.  Return false and set 'error' if invalid.
+ */
+bool batchSolver::parseJob(const string &line, batchJob &job, string &error) {
+   istringstream in(line);
+   string board, option;
+   if (!(in >> job.name >> job.blockFile >> board)) {
+      error = "expected name, block set and board";
+      return false;
+   }
+   job.blockFile     = joinPath(manifestDir, job.blockFile);
+   job.boardFile     = board == "-" ? "" : joinPath(manifestDir, board);
+   job.format        = BINARY_SOLUTIONS;
+   job.engine        = BACKTRACKING_ENGINE;
+   job.countOnly     = false;
+   job.breakSymmetry = false;
+   job.pruning       = false;
+   job.limit         = 0;
+   job.threads       = 1;
+   job.timeLimit     = 0;
+
+   while (in >> option) {
+      size_t equals = option.find('=');
+      string key   = option.substr(0, equals),
+             value = equals == string::npos ? "" : option.substr(equals + 1);
+      char *end = NULL;
+      bool valid = true;
+      if (key == "count-only" && equals == string::npos)
+        job.countOnly = true;
+      else if (key == "prune" && equals == string::npos)
+        job.pruning = true;
+      else if (key == "break-symmetry" && equals == string::npos)
+        job.breakSymmetry = true;
+      else if (key == "limit") {
+         job.limit = strtol(value.c_str(), &end, 10);
+         valid = !value.empty() && *end == 0 && job.limit >= 0;
+      }
+      else if (key == "threads") {
+         job.threads = (int)strtol(value.c_str(), &end, 10);
+         valid = !value.empty() && *end == 0 && job.threads > 0;
+      }
+      else if (key == "time-limit") {
+         job.timeLimit = strtod(value.c_str(), &end);
+         valid = !value.empty() && *end == 0 && job.timeLimit >= 0;
+      }
+      else if (key == "format" && (value == "binary" || value == "text"))
+        job.format = value == "text" ? TEXT_SOLUTIONS : BINARY_SOLUTIONS;
+      else if (key == "engine" && (value == "backtrack" || value == "dlx"))
+        job.engine = value == "dlx" ? EXACT_COVER_ENGINE : BACKTRACKING_ENGINE;
+      else
+        valid = false;
+      if (!valid) {
+         error = "invalid option \"" + option + "\"";
+         return false;
+      }
+   }
+   return true;
+}
+
+/*
+ * Run jobs 'chunk' (all with the same block set and board) in turn on
+ * one puzzle (called on worker thread).
+ */
+void batchSolver::runChunk(const vector<int> &chunk) {
+   loadedPuzzle *p = takePuzzle(jobs[chunk[0]]);
+   for (int i = 0; i < (int)chunk.size(); ++i) {
+      const batchJob &job = jobs[chunk[i]];
+      batchResult &result = results[chunk[i]];
+      runJob(*p, job, result);
+      if (progress) {
+         lock_guard<mutex> guard(lock);
+         progress(job, result);
+      }
+   }
+   givePuzzle(p);
+}
+
+/*
+ * Run 'job' on puzzle 'p', loading its block set and board first if 'p'
+ * does not have them already.
+ */
+void batchSolver::runJob(loadedPuzzle &p, const batchJob &job, batchResult &result) {
+   result.ok        = false;
+   result.complete  = false;
+   result.solutions = 0;
+   result.nodes     = 0;
+   result.seconds   = 0;
+   if (!load(p, job, result))
+     return;
+
+   puzzle &puz = *p.puz;
+   string out = outputPath(job.name + (job.format == TEXT_SOLUTIONS ? ".txt" : ".dat"));
+   puz.setSolutionFile(out.c_str());
+   puz.setSolutionFormat(job.format);
+   puz.setEngine(job.engine);
+   puz.setThreads(job.threads);
+   puz.setCountOnly(job.countOnly);
+   puz.setSolutionLimit(job.limit);
+   puz.setBreakSymmetry(job.breakSymmetry);
+   puz.setExpandSymmetry(false);
+   puz.setPruning(job.pruning);
+   puz.setDeadline(job.timeLimit > 0
+                   ? chrono::steady_clock::now()
+                     + chrono::duration_cast<chrono::steady_clock::duration>(
+                         chrono::duration<double>(job.timeLimit))
+                   : chrono::steady_clock::time_point::max());
+
+   int n = puz.solve();
+   if (n < 0) {
+      result.error = "cannot write \"" + out + "\"";
+      return;
+   }
+   result.ok        = true;
+   result.complete  = puz.getCompleted();
+   result.solutions = n;
+   result.nodes     = puz.getNodeCount();
+   result.seconds   = puz.getTimeTaken();
+
+   ofstream report(outputPath(job.name + BATCH_REPORT_EXT).c_str());
+   report << puz.getReport() << endl;
+}
+
+/*
+ * Give puzzle 'p' the block set and board of 'job' if it does not have
+ * them.  Return false and set error of 'result' if they cannot be read.
+ */
+bool batchSolver::load(loadedPuzzle &p, const batchJob &job, batchResult &result) {
+   result.loaded = p.blockFile != job.blockFile || p.boardFile != job.boardFile;
+   if (!result.loaded)
+     return true;
+   {
+      lock_guard<mutex> guard(lock);
+      ++loads;
+   }
+
+   if (p.boardFile != job.boardFile) {
+      if (job.boardFile.empty())
+        p.puz->setBoard(board());
+      else if (!p.puz->readBoard(job.boardFile.c_str())) {
+         result.error = "cannot read board \"" + job.boardFile + "\"";
+         return false;
+      }
+      p.boardFile = job.boardFile;
+   }
+   if (p.blockFile != job.blockFile) {
+      if (!p.puz->readBlockSet(job.blockFile.c_str())) {
+         result.error = p.puz->getReadError();
+         return false;
+      }
+      p.blockFile = job.blockFile;
+   }
+   return true;
+}
+
+/*
+ * Return an idle puzzle for 'job': one that has its block set and
+ * board already if possible, otherwise the one used least recently or
+ * a new one.
+ */
+batchSolver::loadedPuzzle *batchSolver::takePuzzle(const batchJob &job) {
+   lock_guard<mutex> guard(lock);
+   int best = -1;
+   for (int i = 0; i < (int)idle.size(); ++i) {
+      if (idle[i]->blockFile == job.blockFile && idle[i]->boardFile == job.boardFile) {
+         best = i;
+         break;
+      }
+      if (best == -1 || idle[i]->lastUsed < idle[best]->lastUsed)
+        best = i;
+   }
+   loadedPuzzle *p;
+   if (best == -1 || ((idle[best]->blockFile != job.blockFile || idle[best]->boardFile != job.boardFile)
+                      && (int)puzzles.size() < workers)) {
+      // none idle, or none suitable and another may be made
+      p = new loadedPuzzle;
+      p->puz = new puzzle;
+      p->boardFile = ""; // default board
+      p->blockFile = "";
+      puzzles.push_back(p);
+   }
+   else {
+      p = idle[best];
+      idle.erase(idle.begin() + best);
+   }
+   p->lastUsed = ++uses;
+   return p;
+}
+
+/*
+ * Return puzzle 'p' to the idle puzzles.
+ */
+void batchSolver::givePuzzle(loadedPuzzle *p) {
+   lock_guard<mutex> guard(lock);
+   idle.push_back(p);
+}
+
+/*
+ * Write a line for each job to BATCH_SUMMARY in output directory.
+ */
+bool batchSolver::writeSummary(void) {
+   ofstream file(outputPath(BATCH_SUMMARY).c_str());
+   if (!file)
+     return false;
+   file << "job,status,solutions,complete,seconds,nodes,loaded,error" << endl;
+   for (int i = 0; i < (int)jobs.size(); ++i) {
+      const batchResult &r = results[i];
+      file << csvField(jobs[i].name) << "," << (r.ok ? "ok" : "failed") << "," << r.solutions
+           << "," << (r.complete ? 1 : 0) << "," << r.seconds << "," << r.nodes << ","
+           << (r.loaded ? 1 : 0) << "," << csvField(r.error) << endl;
+   }
+   return (bool)file;
+}
+
+/*
+ * Return path of file 'name' in output directory.
+ */
+string batchSolver::outputPath(const string &name) {
+   return joinPath(outputDir, name);
+}
@@ -0,0 +1,154 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "batch.h" - Class "batchSolver" definition.                                                     *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <functional>
+
+#include "puzzle.h"
+
+#define BATCH_CHUNK_JOBS  16              // most jobs sharing a block set & board run as one task
+#define BATCH_SUMMARY     "summary.csv"   // summary written to output directory by "run"
+#define BATCH_REPORT_EXT  ".report"       // per job report (see "puzzle::getReport")
+
+/*
+ * One line of a batch manifest (see "batchSolver").
+ */
+struct batchJob {
+   std::string name,
+               blockFile,
+               boardFile; // empty for the default 8 x 8 grid
+   solutionFormat format;
+   solverEngine   engine;
+   bool countOnly,
+        breakSymmetry,
+        pruning;
+   long limit;       // solution limit (0 = none)
+   int  threads;     // threads searching this job
+   double timeLimit; // seconds (0 = none)
+   int  line;        // line of manifest
+};
+
+/*
+ * Outcome of one job.
+ */
+struct batchResult {
+   bool   ok,       // job ran (block set and board read, solution file written)
+          complete, // every solution was found
+          loaded;   // block set or board had to be read (not already loaded)
+   long   solutions,
+          nodes;
+   double seconds;  // time taken by search
+   std::string error;
+};
+
+/*
+ * Solves many puzzles in one process.  A manifest lists one job per
+ * line: a name, a block set file, a board file ('-' for the default
+ * 8 x 8 grid) and options, separated by spaces.  Lines starting with
+ * ';' are comments.  eg.
+ *
+ *    ; name    blocks                 board              options
+ *    default   default_block_set.blk  -                  count-only
+ *    octagon   default_block_set.blk  octagon_board.brd  limit=100 format=text
+ *
+ * Options are "count-only", "prune", "break-symmetry", "limit=N",
+ * "threads=N", "time-limit=SECONDS", "format=binary|text" and
+ * "engine=backtrack|dlx".  File names are relative to the manifest's
+ * directory.
+ *
+ * Jobs run on a pool of worker threads, each job with as many threads
+ * of its own as it asks for.  Jobs sharing a block set and board are
+ * run in turn by the same task (at most BATCH_CHUNK_JOBS at a time), and
+ * each worker's puzzle keeps its block set, board and placement table
+ * for the next job that needs them, so they are read and built once
+ * per worker rather than once per job.  Each job writes its solutions to
+ * "<name>.dat" (or ".txt") and its report to "<name>.report" in the
+ * output directory, and "run" ends by writing a line per job to
+ * BATCH_SUMMARY there (comma separated values, the job name and error
+ * quoted).
+ */
+class batchSolver {
+ public:
+   batchSolver(void);
+   ~batchSolver(void);
+
+   /*
+    * Read jobs from manifest 'fileName'.  Return false and set 'error'
+    * (with the line number) if it cannot be read or a line is invalid.
+    */
+   bool readManifest(const char *fileName, std::string &error);
+
+   /*
+    * Set directory results are written to (created if necessary,
+    * default current directory) and number of jobs run at once
+    * (default number of processors).
+    */
+   void setOutputDir(const char *dir) {outputDir = dir;               }
+   void setWorkers(int n)             {workers = n > 0 ? n : 1;       }
+   int  getWorkers(void)              {return workers;                }
+
+   /*
+    * Call 'f' (from the worker thread, one call at a time) as each job finishes.
+    */
+   void setProgress(const std::function<void(const batchJob &, const batchResult &)> &f) {
+      progress = f;
+   }
+
+   /*
+    * Run every job and write the summary.  Return number of jobs that failed.
+    */
+   int run(void);
+
+   const std::vector<batchJob>    &getJobs(void)    {return jobs;   }
+   const std::vector<batchResult> &getResults(void) {return results;}
+
+   /*
+    * Return time taken by "run" in seconds, and number of times a block
+    * set or board was read.
+    */
+   double getTimeTaken(void)  {return timeTaken;}
+   int    getLoadCount(void)  {return loads;    }
+
+ private:
+   // puzzle of a worker, and the files it has loaded
+   struct loadedPuzzle {
+      puzzle     *puz;
+      std::string blockFile,
+                  boardFile;
+      long        lastUsed; // order last taken
+   };
+
+   bool parseJob(const std::string &line, batchJob &job, std::string &error);
+   void runChunk(const std::vector<int> &chunk);
+   void runJob(loadedPuzzle &p, const batchJob &job, batchResult &result);
+   bool load(loadedPuzzle &p, const batchJob &job, batchResult &result);
+   loadedPuzzle *takePuzzle(const batchJob &job);
+   void givePuzzle(loadedPuzzle *p);
+   bool writeSummary(void);
+   std::string outputPath(const std::string &name);
+
+   std::vector<batchJob>    jobs;
+   std::vector<batchResult> results;
+   std::vector<loadedPuzzle *> puzzles, // all created
+                               idle;    // not in use
+   std::mutex lock; // guards 'idle', 'loads', 'uses' and calls of 'progress'
+   std::function<void(const batchJob &, const batchResult &)> progress;
+   std::string manifestDir,
+               outputDir;
+   int    workers,
+          loads;
+   long   uses;
+   double timeTaken;
+};
+
+#endif
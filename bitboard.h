@@ -0,0 +1,239 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "bitboard.h" - Class template "bitboard" definition.                                            *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define MAX_PUZZLE_HEIGHT 64
+#define MAX_PUZZLE_WIDTH  64
+
+typedef unsigned long long bbWord;
+
+#define BB_WORD_BITS 64
+
+/*
+ * Number of 64 bit words needed to hold one bit for each of 'cells' squares.
+ */
+#define BB_WORDS(cells) (((cells) + BB_WORD_BITS - 1) / BB_WORD_BITS)
+
+#define PUZZLE_BITBOARD_WORDS BB_WORDS(MAX_PUZZLE_HEIGHT * MAX_PUZZLE_WIDTH)
+
+/*
+ * Return index of lowest set bit in 'w' ('w' must not be zero).
+ */
+inline int lowestBit(bbWord w) {
+#if defined(_MSC_VER)
+   unsigned long i;
+   _BitScanForward64(&i, w);
+   return (int)i;
+#else
+   return __builtin_ctzll(w);
+#endif
+}
+
+/*
+ * Fixed size set of bits, one per puzzle grid square, held row after
+ * row in consecutive words.  Square (r, c) of a puzzle "width" squares
+ * wide is bit (r * width + c).  For puzzles of up to 64 squares (eg.
+ * the default 8x8 grid) only word 0 is ever used, and callers may
+ * operate on it directly.  The search is compiled for 1 and 2 word
+ * bitboards (grids of up to 64 and 128 squares) and for the largest
+ * grid, PUZZLE_BITBOARD_WORDS words (see "placementTable").
+ */
+template <int WORDS>
+class bitboard {
+ public:
+   void clear(void) {
+      for (int i = 0; i < WORDS; ++i)
+        w[i] = 0;
+   }
+
+   bbWord  word(int i) const {return w[i];}
+   bbWord &word(int i)       {return w[i];}
+
+   bool test(int b) const {return (w[b / BB_WORD_BITS] >> (b % BB_WORD_BITS)) & 1;}
+   void set(int b)        {w[b / BB_WORD_BITS] |=  (bbWord)1 << (b % BB_WORD_BITS);}
+   void reset(int b)      {w[b / BB_WORD_BITS] &= ~((bbWord)1 << (b % BB_WORD_BITS));}
+
+   /*
+    * Test whether any bit is set in both this bitboard and 'b'.
+    */
+   bool intersects(const bitboard &b) const {
+      for (int i = 0; i < WORDS; ++i)
+        if (w[i] & b.w[i])
+          return true;
+      return false;
+   }
+
+   bool empty(void) const {
+      for (int i = 0; i < WORDS; ++i)
+        if (w[i])
+          return false;
+      return true;
+   }
+
+   /*
+    * Return the index of the first set bit (bitboard must not be empty).
+    */
+   int firstSet(void) const {
+      int i = 0;
+      while (!w[i])
+        ++i;
+      return i * BB_WORD_BITS + lowestBit(w[i]);
+   }
+
+   bitboard &operator&=(const bitboard &b) {
+      for (int i = 0; i < WORDS; ++i)
+        w[i] &= b.w[i];
+      return *this;
+   }
+
+   /*
+    * Clear every bit that is set in 'b'.
+    */
+   bitboard &andNot(const bitboard &b) {
+      for (int i = 0; i < WORDS; ++i)
+        w[i] &= ~b.w[i];
+      return *this;
+   }
+
+   bitboard &operator|=(const bitboard &b) {
+      for (int i = 0; i < WORDS; ++i)
+        w[i] |= b.w[i];
+      return *this;
+   }
+
+   bitboard &operator^=(const bitboard &b) {
+      for (int i = 0; i < WORDS; ++i)
+        w[i] ^= b.w[i];
+      return *this;
+   }
+
+   /*
+    * Copy bits from a bitboard of a different size, dropping or
+    * clearing words as necessary.
+    */
+   template <int W>
+   void copyFrom(const bitboard<W> &b) {
+      for (int i = 0; i < WORDS; ++i)
+        w[i] = i < W ? b.word(i) : 0;
+   }
+
+   bool operator==(const bitboard &b) const {
+      for (int i = 0; i < WORDS; ++i)
+        if (w[i] != b.w[i])
+          return false;
+      return true;
+   }
+
+   /*
+    * Compare as unsigned integers (bit 0 least significant).
+    */
+   bool operator<(const bitboard &b) const {
+      for (int i = WORDS - 1; i >= 0; --i)
+        if (w[i] != b.w[i])
+          return w[i] < b.w[i];
+      return false;
+   }
+
+   /*
+    * Return number of bits set.
+    */
+   int count(void) const {
+      int n = 0;
+      for (int i = 0; i < WORDS; ++i)
+        for (bbWord v = w[i]; v; v &= v - 1)
+          ++n;
+      return n;
+   }
+
+   /*
+    * Set this bitboard to the 'n' words at 'src' moved 'shift' places
+    * towards the high end (bits moved past the end are lost).
+    */
+   void loadShifted(const bbWord *src, const int n, const int shift) {
+      int wordShift = shift / BB_WORD_BITS,
+          bitShift  = shift % BB_WORD_BITS,
+          i;
+      clear();
+      for (i = 0; i < n && i + wordShift < WORDS; ++i) {
+         w[i + wordShift] |= src[i] << bitShift;
+         if (bitShift && i + wordShift + 1 < WORDS)
+           w[i + wordShift + 1] |= src[i] >> (BB_WORD_BITS - bitShift);
+      }
+   }
+
+   /*
+    * Move every bit 'n' places towards the high end of the set
+    * (ie. bit b becomes bit b + n).  Bits shifted past the end are lost.
+    */
+   void shiftLeft(int n) {
+      int wordShift = n / BB_WORD_BITS,
+          bitShift  = n % BB_WORD_BITS,
+          i;
+      for (i = WORDS - 1; i >= 0; --i) {
+         bbWord v = 0;
+         if (i - wordShift >= 0) {
+            v = w[i - wordShift] << bitShift;
+            if (bitShift && i - wordShift - 1 >= 0)
+              v |= w[i - wordShift - 1] >> (BB_WORD_BITS - bitShift);
+         }
+         w[i] = v;
+      }
+   }
+
+   /*
+    * Move every bit 'n' places towards the low end of the set
+    * (ie. bit b becomes bit b - n).  Bits shifted past bit 0 are lost.
+    */
+   void shiftRight(int n) {
+      int wordShift = n / BB_WORD_BITS,
+          bitShift  = n % BB_WORD_BITS,
+          i;
+      for (i = 0; i < WORDS; ++i) {
+         bbWord v = 0;
+         if (i + wordShift < WORDS) {
+            v = w[i + wordShift] >> bitShift;
+            if (bitShift && i + wordShift + 1 < WORDS)
+              v |= w[i + wordShift + 1] << (BB_WORD_BITS - bitShift);
+         }
+         w[i] = v;
+      }
+   }
+
+   /*
+    * Return the index of the first clear bit at or after 'from' and
+    * before 'limit', or 'limit' if there is none.
+    */
+   int firstClear(int from, int limit) const {
+      int i = from / BB_WORD_BITS;
+      if (i >= WORDS)
+        return limit;
+      bbWord free = ~w[i] & (~(bbWord)0 << (from % BB_WORD_BITS));
+      for (;;) {
+         if (free) {
+            int b = i * BB_WORD_BITS + lowestBit(free);
+            return b < limit ? b : limit;
+         }
+         if (++i >= WORDS || i * BB_WORD_BITS >= limit)
+           return limit;
+         free = ~w[i];
+      }
+   }
+
+ private:
+   bbWord w[WORDS];
+};
+
+typedef bitboard<PUZZLE_BITBOARD_WORDS> puzzleBitboard;
+
+#endif
@@ -6,9 +6,14 @@
 *                                                                                                 *
 \*************************************************************************************************/
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "block.h"
 
-int block::blockCount = 0;
+using namespace std;
+
+atomic<int> block::blockCount(0);
 
 // PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
 
@@ -20,6 +25,10 @@ block::block(void) {
    origHoldPos.r = -1;
    origHoldPos.c = -1;
    TLcol         = -1;
+   orientation   = 0;
+   height = width = side = 0;
+   grid          = NULL;
+   masks         = NULL;
    ++blockCount;
 }
 
@@ -30,22 +39,41 @@ block::~block(void) {
    --blockCount;
 }
 
+/*
+ * Make block 'h' x 'w' squares from 'squares' (row by row), held at 'hold',
+ * with its grid in 'storage'.
+ */
+void block::setShape(const int h, const int w, const vector<bool> &squares, const pos hold,
+                     unsigned char *storage) {
+   height      = h;
+   width       = w;
+   orientation = 0;
+   origHoldPos = hold;
+   holdPos     = hold;
+
+   // square grid big enough for every orientation
+   side = height > width ? height : width;
+   grid = storage;
+   memset(grid, 0, side * side);
+   for (int r = 0; r < height; ++r)
+     for (int c = 0; c < width; ++c)
+       grid[r * side + c] = squares[r * width + c];
+   findTLcol();
+   findUniqueOrientations();
+}
+
 /*
  * Rotate block 90 degrees clockwise.
  */
 void block::rotate(void) {
-   bool tempGrid[MAX_BLOCK_SIZE][MAX_BLOCK_SIZE];
-   
-   // copy grid to tempGrid
-   int r, c;
-   for (r = 0; r < height; ++r)
-     for (c = 0; c < width; ++c)
-       tempGrid[r][c] = grid[r][c];
+   unsigned char tempGrid[MAX_BLOCK_SIDE * MAX_BLOCK_SIDE];
+   memcpy(tempGrid, grid, side * side);
 
    // exchange rows with reversed columns
+   int r, c;
    for (r = 0; r < height; ++r)
      for (c = 0; c < width; ++c)
-       grid[c][height - 1 - r] = tempGrid[r][c];
+       grid[c * side + height - 1 - r] = tempGrid[r * side + c];
 
    // update holdPos
    int temp  = holdPos.r;
@@ -70,16 +98,16 @@ void block::rotate(void) {
  * Flip block vertically.
  */
 void block::flip(void) {
-   bool temp;
+   unsigned char temp;
    int rFinish = height / 2,
        r, c;
 
    // flip grid vertically
    for (r = 0; r < rFinish; ++r)
      for (c = 0; c < width; ++c) {
-        temp = grid[height - 1 - r][c];
-	     grid[height - 1 - r][c] = grid[r][c];
-	     grid[r][c] = temp;
+        temp = grid[(height - 1 - r) * side + c];
+	     grid[(height - 1 - r) * side + c] = grid[r * side + c];
+	     grid[r * side + c] = temp;
      }
 
    // update orientation
@@ -108,6 +136,65 @@ void block::changeOrientation(const int newOrientation) {
        rotate();
 }
 
+/*
+ * Find extent of squares of the block in each orientation, and so the
+ * words its mask needs in a puzzle grid "puzzleWidth" squares wide (each
+ * mask is only as long as the squares of the block require).  Return
+ * the words needed by all 8 masks.
+ */
+int block::measureMasks(const int puzzleWidth) {
+   int oldOrientation = orientation,
+       o, r, c;
+
+   maskStart[0] = 0;
+   for (o = 0; o < 8; ++o) {
+      changeOrientation(o);
+
+      // find extent of squares (bounding box may contain empty rows/columns)
+      maskLeft[o]   = width;
+      maskRight[o]  = -1;
+      maskBottom[o] = -1;
+      for (r = 0; r < height; ++r)
+        for (c = 0; c < width; ++c)
+          if (grid[r * side + c]) {
+             if (c < maskLeft[o])  maskLeft[o]  = c;
+             if (c > maskRight[o]) maskRight[o] = c;
+             maskBottom[o] = r;
+          }
+
+      maskStart[o + 1] = maskStart[o]
+                         + BB_WORDS(maskBottom[o] * puzzleWidth + maskRight[o] - maskLeft[o] + 1);
+   }
+
+   changeOrientation(oldOrientation);
+   return maskStart[8];
+}
+
+/*
+ * Build occupancy masks of the block in each orientation in 'm' (as
+ * measured by "measureMasks").  Square (r, c) of the orientated block is
+ * bit (r * puzzleWidth + c - maskLeft) of its mask, so that shifting the
+ * mask left by the grid index of the square the block's leftmost column
+ * meets its top row superimposes the block on the puzzle grid.
+ */
+void block::buildMasks(const int puzzleWidth, bbWord *m) {
+   int oldOrientation = orientation,
+       o, r, c;
+
+   for (o = 0; o < 8; ++o) {
+      changeOrientation(o);
+      for (r = 0; r < height; ++r)
+        for (c = 0; c < width; ++c)
+          if (grid[r * side + c]) {
+             int b = r * puzzleWidth + c - maskLeft[o];
+             m[maskStart[o] + b / BB_WORD_BITS] |= (bbWord)1 << (b % BB_WORD_BITS);
+          }
+   }
+   masks = m;
+
+   changeOrientation(oldOrientation);
+}
+
 /*
  * Prints block information to screen in text format.
  */
@@ -116,7 +203,7 @@ void block::print(void) {
    int r, c;
    for (r = 0; r < height; ++r) {
       for (c = 0; c < width; ++c) {
-         if (grid[r][c])
+         if (grid[r * side + c])
            cout << (char)219 << (char)219;
          else
            cout << "  ";
@@ -134,21 +221,15 @@ void block::print(void) {
  * 'uniqueOrientations[8]' is set to 'true' else 'false'.
  */
 void block::findUniqueOrientations(void) {
-   bool testGrid[8][MAX_BLOCK_SIZE][MAX_BLOCK_SIZE];
+   vector<unsigned char> testGrid(8 * side * side); // grid in each orientation, one after another
    int testGridH[8], testGridW[8], // height and width of block in testGrid
-       i, j, // counters
-       r, c;
+       i, j; // counters
 
-   // initialize 'testGrid[8][size]' & 'uniqueOrient[8]'
+   // initialize 'testGrid' & 'uniqueOrient[8]'
    for (i = 0; i < 8; ++i) {
       uniqueOrient[i] = true;
       changeOrientation(i);
-
-      // copy 'grid' to 'testGrid'
-      for (r = 0; r < height; ++r)
-        for (c = 0; c < width; ++c)
-          testGrid[i][r][c] = grid[r][c];
-
+      memcpy(&testGrid[i * side * side], grid, side * side);
       testGridH[i] = height;
       testGridW[i] = width;
    }
@@ -156,11 +237,11 @@ void block::findUniqueOrientations(void) {
    // eliminate orientations that are not unique
    for (i = 0; i < 7; ++i) {
       if (uniqueOrient[i])
-        for (j = i + 1; j < 8; ++j) {
-           changeOrientation(i);
-           if (gridEqual(testGridH[j], testGridW[j], testGrid[j]))
-             uniqueOrient[j] = false;
-        }
+        for (j = i + 1; j < 8; ++j)
+          if (testGridH[i] == testGridH[j] && testGridW[i] == testGridW[j] &&
+              gridEqual(testGridH[i], testGridW[i], &testGrid[i * side * side],
+                        &testGrid[j * side * side]))
+            uniqueOrient[j] = false;
    }
 
    // reset block orientation
@@ -168,19 +249,15 @@ void block::findUniqueOrientations(void) {
 }
 
 /*
- * Test whether block stored in 'g' is equivalent to that in 'grid'
- * return true if equivalent, false otherwise.
+ * Test whether the 'h' by 'w' blocks stored in 'g1' and 'g2' (laid out as
+ * 'grid') are equivalent, return true if equivalent, false otherwise.
  */
-bool block::gridEqual(const int h, const int w, const bool g[][MAX_BLOCK_SIZE]) {
-   if (h != height || w != width)
-     return false;
-   else {
-      int r, c;
-      for (r = 0; r < height; ++r)
-        for (c = 0; c < width; ++c)
-          if (g[r][c] != grid[r][c])
-            return false;
-   }
+bool block::gridEqual(const int h, const int w, const unsigned char *g1, const unsigned char *g2) {
+   int r, c;
+   for (r = 0; r < h; ++r)
+     for (c = 0; c < w; ++c)
+       if (g1[r * side + c] != g2[r * side + c])
+         return false;
    return true;
 }
 
@@ -190,7 +267,7 @@ bool block::gridEqual(const int h, const int w, const bool g[][MAX_BLOCK_SIZE])
  */
 inline void block::findTLcol(void) {
    for (TLcol = 0; TLcol < width; ++TLcol)
-     if (grid[0][TLcol])
+     if (grid[TLcol])
 	    break;
 }
 
@@ -200,66 +277,3 @@ ostream &operator<<(ostream &output, block *bPtr) {
    output << bPtr->getColour() << " " << bPtr->getOrientation();
    return output;
 }
-
-istream &operator>>(istream &input, block &b) {
-   // input colour
-   int red, green, blue;
-   input >> red >> green >> blue;
-   b.colour = RGB(red, green, blue);
-     
-   input.eatwhite();
-
-   // input grid, height, width
-   b.height = b.width = 0;
-   int r = 0, c = 0;
-   char ch;
-   bool finished = false, newLine = false;
-   while (!finished) {
-      ch = (char)input.get();
-      switch (ch) {
-       case '0':
-         b.grid[r][c] = false;
-         newLine = false;
-         ++c;
-         break;
-       case '1':
-         b.grid[r][c] = true;
-         newLine = false;
-         ++c;
-         break;
-       case '2':
-         // set origHoldPos
-         b.origHoldPos.r = r;
-         b.origHoldPos.c = c;
-         b.grid[r][c] = true;
-         newLine = false;
-         ++c;
-         break;
-       case '\n':
-         if (newLine) // test for two consecutive newLines
-           finished = true;
-         else {
-            newLine = true;
-            b.width = c;
-            c = 0;
-            ++r;
-         } break;
-       case EOF:
-         finished = true;
-         ++r;
-         break;
-       default:
-         cerr << "Block read error (1).";
-      }
-   }
-   b.height = r;
-   b.findTLcol();
-
-   // error check;
-   if (b.TLcol == -1 || b.origHoldPos.r == -1 || b.origHoldPos.c == -1)
-     cerr << "Block read error (2).";
-
-   b.findUniqueOrientations();
-
-   return input;
-}
\ No newline at end of file
@@ -6,20 +6,34 @@
 *                                                                                                 *
 \*************************************************************************************************/
 
-#ifndef BLOCK_H
+#ifndef BLOCK_H
 #define BLOCK_H
 
-#include <iostream.h>
-#include <windows.h>
+#include <iostream>
+#include <vector>
+#include <atomic>
 #include <assert.h>
 
-#include "misc.h"
+#include "colour.h"
+#include "pos.h"
+#include "bitboard.h"
 
-#define MAX_BLOCK_SIZE 6
+#define MAX_NUMBER_BLOCKS 64 // one bit each in a "blockMask"
+#define MAX_BLOCK_SIDE    64 // rows or columns of a block (no more fit the largest grid)
 
+/*
+ * Set of blocks of a block set, bit 'i' set for block 'i'.
+ */
+typedef unsigned long long blockMask;
+
+/*
+ * A block does not own its grid or masks: they are held, with those of
+ * the rest of its block set, in one pool kept by a "blockSet" (see
+ * "blockset.h").
+ */
 class block {
-   friend ostream &operator<<(ostream &, block *);
-   friend istream &operator>>(istream &, block &);
+   friend std::ostream &operator<<(std::ostream &, block *);
+   friend class blockSet;
 
  public:
    block(void);
@@ -37,14 +51,36 @@ class block {
    pos      getPuzPos(void)       {return puzPos;     }
    pos      getHoldPos(void)      {return holdPos;    }
    int      getTLcol(void)        {return TLcol;      }
-   bool     getGrid(int r, int c) {return grid[r][c]; }
+   bool     getGrid(int r, int c) {return grid[r * side + c];}
    COLORREF getColour(void)       {return colour;     }
 
+   /*
+    * Occupancy mask of block in its current orientation (see "buildMasks"),
+    * "getMaskWords()" words long.  Bit 0 of the mask is the square in the
+    * top row of the block and in column "getMaskLeft()", ie. the leftmost
+    * column containing a square.
+    */
+   const bbWord *getMask(void) {return &masks[maskStart[orientation]];}
+   int getMaskWords(void) {return maskStart[orientation + 1] - maskStart[orientation];}
+   int getMaskLeft(void)   {return maskLeft[orientation];  }
+   int getMaskRight(void)  {return maskRight[orientation]; }
+   int getMaskBottom(void) {return maskBottom[orientation];}
+
    /*
     * Return total number of block objects instantiated.
     */
    int getBlockCount(void) {return blockCount;}
 
+   /*
+    * Make block 'h' x 'w' squares in orientation 0, square (r, c) being
+    * filled if 'squares[r * w + c]' is set, held by the mouse pointer
+    * at square 'hold' (see "blockset.h", which reads blocks from file).
+    * The grid of the block is kept in 'storage', the square of the
+    * greater of 'h' and 'w' bytes long.
+    */
+   void setShape(int h, int w, const std::vector<bool> &squares, pos hold,
+                 unsigned char *storage);
+
    /*
     * Rotate block 90 degrees clockwise.
     */
@@ -63,6 +99,21 @@ class block {
     *  4, 5, 6, 7 = flipped verically then rotated (0, 1, 2, 3) *90 degrees clockwise)
     */
    void changeOrientation(int newOrientation);
+
+   /*
+    * Find the extent of the occupancy masks of the block in each of its
+    * 8 orientations for a puzzle grid "puzzleWidth" squares wide, and
+    * return the number of words they need altogether.
+    */
+   int measureMasks(int puzzleWidth);
+
+   /*
+    * Build the masks measured by "measureMasks" in 'm' (zeroed, as many
+    * words as it returned), so that square (r, c) of the block is bit
+    * (r * puzzleWidth + c - getMaskLeft()) of the mask.  Both must be
+    * called again whenever the width of the puzzle grid changes.
+    */
+   void buildMasks(int puzzleWidth, bbWord *m);
     
    /*
     * Print block info (grid, unique orientations, current 
@@ -81,21 +132,27 @@ class block {
     *      A block with no symmetry has 8 unique orientations (0-7).)
     */
    bool uniqueOrientation(int o) {return uniqueOrient[o];}
-   
+   
  private:
-   void findUniqueOrientations(void);
-   bool gridEqual(const int, const int, const bool [][MAX_BLOCK_SIZE]);
+   void findUniqueOrientations(void);
+   bool gridEqual(const int, const int, const unsigned char *, const unsigned char *);
    void findTLcol(void);
    
    int  height, width, orientation,
+        side,  // rows and columns of 'grid' (greater of height and width)
         TLcol; // column of blocks TL square (row is always 0)
-   bool grid[MAX_BLOCK_SIZE][MAX_BLOCK_SIZE],
-        uniqueOrient[8];
+   unsigned char *grid; // square (r, c) of block is grid[r * side + c] (in block set's pool)
+   bool uniqueOrient[8];
    pos  puzPos,      // position in puzzle of blocks TL square
         origHoldPos, // position of block mouse will hold when block is picked up from queue
-        holdPos;     // position of block held by mouse pointer
+        holdPos;     // position of block held by mouse pointer
    COLORREF colour;
-   static int blockCount; // total no. of blocks instantiated
-};
-
+   const bbWord *masks;    // occupancy mask of each orientation, one after another (in pool)
+   int  maskStart[9],      // index in 'masks' of mask of each orientation (and end of last)
+        maskLeft[8],       // leftmost column containing a square
+        maskRight[8],      // rightmost column containing a square
+        maskBottom[8];     // bottom row containing a square
+   static std::atomic<int> blockCount; // total no. of blocks instantiated (by any thread)
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "block_puzzle_batch.cpp" - Main function of batch solver "block_puzzle_batch".                  *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "batch.h"
+
+static void usage(const char *program) {
+   fprintf(stderr,
+           "usage: %s [options] MANIFEST\n"
+           "  --workers N         jobs run at once (default number of processors)\n"
+           "  --out DIR           directory results are written to (default current)\n"
+           "  --quiet             do not report each job as it finishes\n"
+           "Runs each job of MANIFEST (see batch.h), writing <name>.dat (or .txt),\n"
+           "<name>" BATCH_REPORT_EXT " and " BATCH_SUMMARY " to DIR.\n",
+           program);
+}
+
+int main(int argc, char *argv[]) {
+   const char *manifest = NULL;
+   bool quiet = false;
+   batchSolver batch;
+
+   for (int i = 1; i < argc; ++i) {
+      const char *arg = argv[i],
+                 *val = i + 1 < argc ? argv[i + 1] : NULL;
+      if (strcmp(arg, "--quiet") == 0)
+        quiet = true;
+      else if (strcmp(arg, "--help") == 0) {
+         usage(argv[0]);
+         return 0;
+      }
+      else if (strcmp(arg, "--workers") == 0 && val != NULL) {
+         batch.setWorkers(atoi(val));
+         ++i;
+      }
+      else if (strcmp(arg, "--out") == 0 && val != NULL) {
+         batch.setOutputDir(val);
+         ++i;
+      }
+      else if (arg[0] != '-' && manifest == NULL)
+        manifest = arg;
+      else {
+         usage(argv[0]);
+         return 2;
+      }
+   }
+   if (manifest == NULL) {
+      usage(argv[0]);
+      return 2;
+   }
+
+   std::string error;
+   if (!batch.readManifest(manifest, error)) {
+      fprintf(stderr, "%s: %s\n", argv[0], error.c_str());
+      return 1;
+   }
+   if (!quiet)
+     batch.setProgress([](const batchJob &job, const batchResult &result) {
+        if (result.ok)
+          fprintf(stderr, "%-20s %10ld solutions%s %8.2f s%s\n", job.name.c_str(), result.solutions,
+                  result.complete ? " " : "+", result.seconds, result.loaded ? "" : " (reused)");
+        else
+          fprintf(stderr, "%-20s failed: %s\n", job.name.c_str(), result.error.c_str());
+     });
+
+   int failed = batch.run();
+   double seconds = batch.getTimeTaken();
+   printf("%d jobs (%d failed) in %.2f seconds, %.0f jobs/hour, %d loads\n",
+          (int)batch.getJobs().size(), failed, seconds,
+          seconds > 0 ? batch.getJobs().size() * 3600.0 / seconds : 0.0, batch.getLoadCount());
+   return failed > 0 ? 1 : 0;
+}
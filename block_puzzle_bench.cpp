@@ -0,0 +1,467 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "block_puzzle_bench.cpp" - Main function of solver benchmark "block_puzzle_bench".              *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "puzzle.h"
+#include "gridview.h"
+#include "framebuf.h"
+
+#ifndef BLOCK_PUZZLE_DATA_DIR
+#define BLOCK_PUZZLE_DATA_DIR "."
+#endif
+
+#define BENCH_SOLUTION_FILE "bench_solution.dat"
+
+/*
+ * Block set solved by the benchmark and its known number of solutions
+ * on the 8x8 grid.  Sets with no file name are generated (see
+ * "generateBlockSet") from the seed.
+ */
+struct benchSet {
+   const char   *name,
+                *fileName;
+   unsigned long seed;
+   long          expected;
+};
+
+static const benchSet benchSets[] = {
+   {"default",     "default_block_set.blk", 0, 101792},
+   {"set_2",       "block_set_2.blk",       0,    192},
+   {"tetris",      "tetris_block_set.blk",  0,      0},
+   {"generated_1", NULL,                    1,     64},
+   {"generated_2", NULL,                    2,    640},
+   {"generated_3", NULL,                    3,     80}
+};
+
+#define BENCH_SET_COUNT ((int)(sizeof(benchSets) / sizeof(benchSets[0])))
+
+/*
+ * Result of one solve.
+ */
+struct benchRun {
+   const benchSet *set;
+   int    repeat;
+   long   solutions,
+          nodes,
+          tested;
+   double loadTime,
+          solveTime;
+   long   peakRSS; // kilobytes
+   bool   ok;
+};
+
+/*
+ * Result of redrawing one grid size (see "benchRender").
+ */
+struct benchDraw {
+   int    side,        // grid is side x side squares
+          frames;
+   double frameTime;   // seconds per redraw
+   long   presents;    // rectangles shown per redraw
+   double dragTime,    // seconds per move of a held block
+          dragPresents, // rectangles shown per move
+          dragPixels;   // pixels shown per move
+};
+
+static const int renderSides[] = {8, 25, 64};
+
+/*
+ * Time 'frames' redraws ("puzzle::draw") of an empty 'side' x 'side'
+ * grid through "gridView" into an in-memory frame buffer, then
+ * 'frames' moves of a block of block set 'blockFile' held over it as
+ * the GUI does when it is dragged (one square at a time along each row
+ * in turn, rotated every fourth move).
+ */
+static benchDraw benchRender(const int side, const int frames, const char *blockFile) {
+   puzzle puz;
+   frameBuffer buffer;
+   gridView view(&buffer);
+   puz.setBoard(board(side, side));
+   puz.setView(&view);
+   buffer.resetCounts();
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   int i;
+   for (i = 0; i < frames; ++i) {
+      view.invalidate(); // else unchanged squares are not drawn again
+      puz.draw();
+   }
+   benchDraw d;
+   d.side      = side;
+   d.frames    = frames;
+   d.frameTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                 / frames;
+   d.presents  = buffer.getPresentCount() / frames;
+
+   d.dragTime = d.dragPresents = d.dragPixels = 0;
+   if (puz.readBlockSet(blockFile)) {
+      puz.pickUpBlock();
+      pos p = {0, 0};
+      puz.drawBlock(p);
+      buffer.resetCounts();
+      start = std::chrono::steady_clock::now();
+      for (i = 0; i < frames; ++i) {
+         puz.beginDraw();
+         puz.eraseBlock(p);
+         p.c += p.r % 2 == 0 ? 1 : -1;
+         if (p.c < 0 || p.c == side) {
+            p.c = p.c < 0 ? 0 : side - 1;
+            p.r = (p.r + 1) % side;
+         }
+         if (i % 4 == 3)
+           puz.rotateBlock();
+         puz.drawBlock(p);
+         puz.endDraw();
+      }
+      d.dragTime     = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                       / frames;
+      d.dragPresents = (double)buffer.getPresentCount() / frames;
+      d.dragPixels   = (double)buffer.getPresentedPixels() / frames;
+   }
+   puz.setView(NULL);
+   return d;
+}
+
+/*
+ * Return peak resident set size of this process so far in kilobytes.
+ */
+static long peakRSS(void) {
+#ifdef _WIN32
+   PROCESS_MEMORY_COUNTERS pmc;
+   if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+     return (long)(pmc.PeakWorkingSetSize / 1024);
+   return 0;
+#else
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+   return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+   return usage.ru_maxrss;
+#endif
+#endif
+}
+
+/*
+ * Pseudo random numbers (xorshift64*) that are the same on every platform.
+ */
+class benchRandom {
+ public:
+   benchRandom(unsigned long long seed) {state = seed * 0x9e3779b97f4a7c15ULL + 1;}
+   int next(int n) {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return (int)((state * 0x2545f4914f6cdd1dULL >> 33) % n);
+   }
+ private:
+   unsigned long long state;
+};
+
+#define GENERATED_MIN_BLOCK 5 // squares in each block of a generated block set
+#define GENERATED_MAX_BLOCK 7
+#define GENERATED_MAX_SIDE  6  // rows/columns of a generated block, and blocks in a generated
+#define GENERATED_MAX_COUNT 15 // set (the block set limits when the known counts were found)
+
+/*
+ * Cut an 8x8 grid into random blocks of "GENERATED_MIN_BLOCK" to
+ * "GENERATED_MAX_BLOCK" squares that fit the limits above, and
+ * write them to 'fileName' as a block set.  The set has at least one
+ * solution.
+ */
+static bool generateBlockSet(const unsigned long seed, const char *fileName) {
+   const int size = 8;
+   benchRandom rnd(seed);
+   int piece[size][size], nPieces, smallest, r, c, i;
+
+   for (;;) {
+      for (r = 0; r < size; ++r)
+        for (c = 0; c < size; ++c)
+          piece[r][c] = -1;
+      nPieces  = 0;
+      smallest = size * size;
+      for (i = 0; i < size * size; ++i) {
+         if (piece[i / size][i % size] != -1)
+           continue;
+         // grow block from first empty square by adding random empty neighbours
+         int target = GENERATED_MIN_BLOCK + rnd.next(GENERATED_MAX_BLOCK - GENERATED_MIN_BLOCK + 1),
+             cells  = 1,
+             top = i / size, bottom = top, left = i % size, right = left;
+         piece[top][left] = nPieces;
+         while (cells < target) {
+            pos options[size * size];
+            int nOptions = 0;
+            for (r = 0; r < size; ++r)
+              for (c = 0; c < size; ++c) {
+                 if (piece[r][c] != -1)
+                   continue;
+                 bool adjacent = (r > 0 && piece[r - 1][c] == nPieces)
+                              || (r < size - 1 && piece[r + 1][c] == nPieces)
+                              || (c > 0 && piece[r][c - 1] == nPieces)
+                              || (c < size - 1 && piece[r][c + 1] == nPieces);
+                 int h = (r > bottom ? r : bottom) - (r < top ? r : top) + 1,
+                     w = (c > right ? c : right) - (c < left ? c : left) + 1;
+                 if (adjacent && h <= GENERATED_MAX_SIDE && w <= GENERATED_MAX_SIDE) {
+                    options[nOptions].r = r;
+                    options[nOptions].c = c;
+                    ++nOptions;
+                 }
+              }
+            if (nOptions == 0)
+              break;
+            pos p = options[rnd.next(nOptions)];
+            piece[p.r][p.c] = nPieces;
+            if (p.r > bottom) bottom = p.r;
+            if (p.c < left)   left   = p.c;
+            if (p.c > right)  right  = p.c;
+            ++cells;
+         }
+         if (cells < smallest)
+           smallest = cells;
+         ++nPieces;
+      }
+      if (smallest >= GENERATED_MIN_BLOCK && nPieces <= GENERATED_MAX_COUNT)
+        break; // otherwise blocks hemmed in too small, try again
+   }
+
+   std::ofstream file(fileName);
+   if (!file)
+     return false;
+   for (i = 0; i < nPieces; ++i) {
+      int top = size, bottom = -1, left = size, right = -1;
+      for (r = 0; r < size; ++r)
+        for (c = 0; c < size; ++c)
+          if (piece[r][c] == i) {
+             if (r < top)    top    = r;
+             if (r > bottom) bottom = r;
+             if (c < left)   left   = c;
+             if (c > right)  right  = c;
+          }
+      file << 40 + i * 53 % 200 << " " << 40 + i * 97 % 200 << " " << 40 + i * 151 % 200 << "\n";
+      bool hold = false;
+      for (r = top; r <= bottom; ++r) {
+         for (c = left; c <= right; ++c)
+           if (piece[r][c] != i)
+             file << '0';
+           else if (!hold) {
+              file << '2'; // hold block by its first square
+              hold = true;
+           }
+           else
+             file << '1';
+         file << "\n";
+      }
+      file << "\n";
+   }
+   return true;
+}
+
+static void usage(const char *program) {
+   fprintf(stderr,
+           "usage: %s [options]\n"
+           "  --repeat N          solve each block set N times (default 1)\n"
+           "  --format FORMAT     'json' (default) or 'csv'\n"
+           "  --output FILE       write results to FILE instead of stdout\n"
+           "  --data DIR          directory holding shipped block sets\n"
+           "  --set NAME          only run block set NAME (may be repeated)\n"
+           "  --engine NAME       'backtrack' (default) or 'dlx' (exact cover)\n"
+           "  --threads N         threads used by backtracking engine (0 = all processors)\n"
+           "  --prune             abandon placements leaving unfillable regions\n"
+           "  --break-symmetry    find only one of each set of symmetric solutions\n"
+           "  --render N          also time N redraws of 8x8, 25x25 and 64x64 grids in memory,\n"
+           "                      and N moves of a block dragged over them\n",
+           program);
+}
+
+int main(int argc, char *argv[]) {
+   const char *format  = "json",
+              *outName = NULL;
+   std::string dataDir = BLOCK_PUZZLE_DATA_DIR;
+   std::vector<std::string> only;
+   int repeat = 1, renderFrames = 0, i, j;
+   puzzle puz;
+
+   for (i = 1; i < argc; ++i) {
+      const char *arg = argv[i],
+                 *val = i + 1 < argc ? argv[i + 1] : NULL;
+      if (strcmp(arg, "--prune") == 0)
+        puz.setPruning(true);
+      else if (strcmp(arg, "--break-symmetry") == 0)
+        puz.setBreakSymmetry(true);
+      else if (strcmp(arg, "--help") == 0) {
+         usage(argv[0]);
+         return 0;
+      }
+      else if (val == NULL) {
+         usage(argv[0]);
+         return 2;
+      }
+      else {
+         ++i; // options below take a value
+         if (strcmp(arg, "--repeat") == 0)
+           repeat = atoi(val) > 0 ? atoi(val) : 1;
+         else if (strcmp(arg, "--format") == 0 && (strcmp(val, "json") == 0 || strcmp(val, "csv") == 0))
+           format = val;
+         else if (strcmp(arg, "--output") == 0)
+           outName = val;
+         else if (strcmp(arg, "--render") == 0)
+           renderFrames = atoi(val) > 0 ? atoi(val) : 0;
+         else if (strcmp(arg, "--data") == 0)
+           dataDir = val;
+         else if (strcmp(arg, "--set") == 0)
+           only.push_back(val);
+         else if (strcmp(arg, "--engine") == 0 && strcmp(val, "backtrack") == 0)
+           puz.setEngine(BACKTRACKING_ENGINE);
+         else if (strcmp(arg, "--engine") == 0 && strcmp(val, "dlx") == 0)
+           puz.setEngine(EXACT_COVER_ENGINE);
+         else if (strcmp(arg, "--threads") == 0)
+           puz.setThreads(atoi(val) > 0 ? atoi(val) : workStealingPool::hardwareThreads());
+         else {
+            usage(argv[0]);
+            return 2;
+         }
+      }
+   }
+   puz.setSolutionFile(BENCH_SOLUTION_FILE);
+
+   // solve each block set 'repeat' times
+   std::vector<benchRun> runs;
+   bool allOk = true;
+   for (i = 0; i < BENCH_SET_COUNT; ++i) {
+      const benchSet &set = benchSets[i];
+      bool selected = only.empty();
+      for (j = 0; j < (int)only.size(); ++j)
+        if (only[j] == set.name)
+          selected = true;
+      if (!selected)
+        continue;
+
+      std::string fileName;
+      if (set.fileName != NULL)
+        fileName = dataDir + "/" + set.fileName;
+      else {
+         fileName = std::string("bench_") + set.name + ".blk";
+         if (!generateBlockSet(set.seed, fileName.c_str())) {
+            fprintf(stderr, "%s: cannot write \"%s\"\n", argv[0], fileName.c_str());
+            return 1;
+         }
+      }
+
+      for (j = 0; j < repeat; ++j) {
+         benchRun run;
+         run.set    = &set;
+         run.repeat = j + 1;
+
+         std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+         if (!puz.readBlockSet(fileName.c_str())) {
+            fprintf(stderr, "%s: %s\n", argv[0], puz.getReadError().c_str());
+            return 1;
+         }
+         run.loadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+         long found = puz.solve();
+         if (found < 0) {
+            fprintf(stderr, "%s: cannot write \"%s\"\n", argv[0], BENCH_SOLUTION_FILE);
+            return 1;
+         }
+         run.solutions = found;
+         run.solveTime = puz.getTimeTaken();
+         run.nodes     = puz.getNodeCount();
+         run.tested    = puz.getTestedCount();
+         run.peakRSS   = peakRSS();
+         // each solution found stands for "getSymmetryCount" when skipping symmetric solutions
+         run.ok        = found * puz.getSymmetryCount() == set.expected;
+         if (!run.ok) {
+            fprintf(stderr, "%s: block set %s: %ld solutions, expected %ld\n",
+                    argv[0], set.name, found * puz.getSymmetryCount(), set.expected);
+            allOk = false;
+         }
+         runs.push_back(run);
+      }
+      if (set.fileName == NULL)
+        remove(fileName.c_str());
+   }
+   remove(BENCH_SOLUTION_FILE);
+
+   // redraw grids of each size
+   std::vector<benchDraw> draws;
+   if (renderFrames > 0) {
+      const char *fileName = "bench_render.blk";
+      if (!generateBlockSet(1, fileName)) {
+         fprintf(stderr, "%s: cannot write \"%s\"\n", argv[0], fileName);
+         return 1;
+      }
+      for (i = 0; i < (int)(sizeof(renderSides) / sizeof(renderSides[0])); ++i)
+        draws.push_back(benchRender(renderSides[i], renderFrames, fileName));
+      remove(fileName);
+   }
+
+   // report
+   FILE *out = stdout;
+   if (outName != NULL && (out = fopen(outName, "w")) == NULL) {
+      fprintf(stderr, "%s: cannot write \"%s\"\n", argv[0], outName);
+      return 1;
+   }
+   bool json = strcmp(format, "json") == 0;
+   if (json)
+     fprintf(out, "{\n  \"runs\": [\n");
+   else
+     fprintf(out, "set,repeat,solutions,expected,ok,load_s,wall_s,nodes,placements_tested,"
+                  "solutions_per_s,peak_rss_kb\n");
+   for (i = 0; i < (int)runs.size(); ++i) {
+      const benchRun &run = runs[i];
+      double rate = run.solveTime > 0 ? run.solutions / run.solveTime : 0;
+      if (json)
+        fprintf(out, "    {\"set\": \"%s\", \"repeat\": %d, \"solutions\": %ld, \"expected\": %ld, "
+                     "\"ok\": %s, \"load_s\": %.6f, \"wall_s\": %.6f, \"nodes\": %ld, "
+                     "\"placements_tested\": %ld, \"solutions_per_s\": %.1f, \"peak_rss_kb\": %ld}%s\n",
+                run.set->name, run.repeat, run.solutions, run.set->expected,
+                run.ok ? "true" : "false", run.loadTime, run.solveTime, run.nodes,
+                run.tested, rate, run.peakRSS, i + 1 < (int)runs.size() ? "," : "");
+      else
+        fprintf(out, "%s,%d,%ld,%ld,%d,%.6f,%.6f,%ld,%ld,%.1f,%ld\n",
+                run.set->name, run.repeat, run.solutions, run.set->expected, run.ok ? 1 : 0,
+                run.loadTime, run.solveTime, run.nodes, run.tested, rate, run.peakRSS);
+   }
+   if (json && !draws.empty())
+     fprintf(out, "  ],\n  \"render\": [\n");
+   else if (!draws.empty())
+     fprintf(out, "\ngrid,frames,frame_us,presents_per_frame,drag_us,drag_presents,drag_pixels\n");
+   for (i = 0; i < (int)draws.size(); ++i) {
+      const benchDraw &d = draws[i];
+      if (json)
+        fprintf(out, "    {\"grid\": \"%dx%d\", \"frames\": %d, \"frame_us\": %.3f, "
+                     "\"presents_per_frame\": %ld, \"drag_us\": %.3f, \"drag_presents\": %.2f, "
+                     "\"drag_pixels\": %.0f}%s\n",
+                d.side, d.side, d.frames, d.frameTime * 1e6, d.presents, d.dragTime * 1e6,
+                d.dragPresents, d.dragPixels, i + 1 < (int)draws.size() ? "," : "");
+      else
+        fprintf(out, "%dx%d,%d,%.3f,%ld,%.3f,%.2f,%.0f\n", d.side, d.side, d.frames,
+                d.frameTime * 1e6, d.presents, d.dragTime * 1e6, d.dragPresents, d.dragPixels);
+   }
+   if (json)
+     fprintf(out, "  ],\n  \"ok\": %s\n}\n", allOk ? "true" : "false");
+   if (out != stdout)
+     fclose(out);
+
+   return allOk ? 0 : 1;
+}
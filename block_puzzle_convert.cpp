@@ -0,0 +1,105 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "block_puzzle_convert.cpp" - Main function of "block_puzzle_convert", which converts solution   *
+*                              files between text and binary formats.                             *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+
+#include "puzzle.h"
+
+static void usage(const char *program) {
+   fprintf(stderr,
+           "usage: %s --blocks FILE (--to-binary | --to-text) IN OUT\n"
+           "  Convert solution file IN, written for block set FILE, to OUT\n"
+           "  in the other format.\n",
+           program);
+}
+
+/*
+ * Text to binary.  The initial state line gives no positions, so its
+ * blocks are placed as the text viewer places them (each at the next
+ * empty square).
+ */
+static bool toBinary(puzzle &puz, const char *inName, const char *outName) {
+   std::ifstream in(inName);
+   std::vector<piecePlacement> pieces;
+   solutionFileInfo info;
+   solutionWriter writer;
+
+   if (!in || !puz.readTextSolution(in, info.initial) || !puz.addPieces(info.initial))
+     return false;
+   info.height     = puz.getHeight();
+   info.width      = puz.getWidth();
+   info.blockCount = puz.getBlockCount();
+   info.hash       = puz.getBlockSetHash();
+   if (!writer.open(outName, info))
+     return false;
+   while (in.peek() != EOF) {
+      if (!puz.readTextSolution(in, pieces))
+        return false;
+      writer.write(pieces.empty() ? NULL : &pieces[0], (int)pieces.size());
+   }
+   writer.close();
+   return true;
+}
+
+/*
+ * Binary to text.
+ */
+static bool toText(puzzle &puz, const char *inName, const char *outName) {
+   solutionReader reader;
+   std::vector<piecePlacement> pieces;
+
+   if (!reader.open(inName) || reader.getInfo().hash != puz.getBlockSetHash())
+     return false;
+   std::ofstream out(outName);
+   if (!out)
+     return false;
+   const std::vector<piecePlacement> &initial = reader.getInfo().initial;
+   puz.writeTextSolution(out, initial.empty() ? NULL : &initial[0], (int)initial.size());
+   for (long long i = 0; i < reader.getCount(); ++i) {
+      if (!reader.read(i, pieces))
+        return false;
+      puz.writeTextSolution(out, pieces.empty() ? NULL : &pieces[0], (int)pieces.size());
+   }
+   return (bool)out;
+}
+
+int main(int argc, char *argv[]) {
+   const char *blockFile = NULL;
+   int mode = 0, // 1 = to binary, 2 = to text
+       i;
+
+   for (i = 1; i < argc && argv[i][0] == '-'; ++i)
+     if (strcmp(argv[i], "--blocks") == 0 && i + 1 < argc)
+       blockFile = argv[++i];
+     else if (strcmp(argv[i], "--to-binary") == 0)
+       mode = 1;
+     else if (strcmp(argv[i], "--to-text") == 0)
+       mode = 2;
+     else {
+        usage(argv[0]);
+        return 2;
+     }
+   if (blockFile == NULL || mode == 0 || argc - i != 2) {
+      usage(argv[0]);
+      return 2;
+   }
+
+   puzzle puz;
+   if (!puz.readBlockSet(blockFile)) {
+      fprintf(stderr, "%s: %s\n", argv[0], puz.getReadError().c_str());
+      return 1;
+   }
+   if (!(mode == 1 ? toBinary(puz, argv[i], argv[i + 1]) : toText(puz, argv[i], argv[i + 1]))) {
+      fprintf(stderr, "%s: cannot convert \"%s\" (wrong format or block set?)\n", argv[0], argv[i]);
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,90 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "block_puzzle_daemon.cpp" - Main function of solver daemon "block_puzzle_daemon".               *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <string>
+
+#include "daemon.h"
+
+#define DEFAULT_SOCKET "/tmp/block_puzzle.sock"
+
+static solverDaemon *daemonPtr = NULL; // stopped by signal handler
+
+static void stopDaemon(int) {
+   if (daemonPtr != NULL)
+     daemonPtr->stop();
+}
+
+static void usage(const char *program) {
+   fprintf(stderr,
+           "usage: %s [options]\n"
+           "  --socket PATH       socket to listen on (default " DEFAULT_SOCKET ")\n"
+           "  --data DIR          directory of block set and board files (default current)\n"
+           "  --workers N         requests answered at once (default number of processors)\n"
+           "  --puzzles N         loaded puzzles kept (default %d)\n"
+           "Answers solve, count and hint requests (see daemon.h) until interrupted.\n",
+           program, DAEMON_MAX_PUZZLES);
+}
+
+int main(int argc, char *argv[]) {
+   const char *socketPath = DEFAULT_SOCKET,
+              *dataDir    = ".";
+   int workers = 0,
+       puzzles = 0;
+
+   for (int i = 1; i < argc; ++i) {
+      const char *arg = argv[i],
+                 *val = i + 1 < argc ? argv[i + 1] : NULL;
+      if (strcmp(arg, "--help") == 0) {
+         usage(argv[0]);
+         return 0;
+      }
+      else if (val == NULL) {
+         usage(argv[0]);
+         return 2;
+      }
+      ++i; // options below take a value
+      if (strcmp(arg, "--socket") == 0)
+        socketPath = val;
+      else if (strcmp(arg, "--data") == 0)
+        dataDir = val;
+      else if (strcmp(arg, "--workers") == 0)
+        workers = atoi(val);
+      else if (strcmp(arg, "--puzzles") == 0)
+        puzzles = atoi(val);
+      else {
+         usage(argv[0]);
+         return 2;
+      }
+   }
+
+   solverDaemon daemon(dataDir);
+   if (workers > 0)
+     daemon.setWorkers(workers);
+   if (puzzles > 0)
+     daemon.setMaxPuzzles(puzzles);
+   std::string error;
+   if (!daemon.listen(socketPath, error)) {
+      fprintf(stderr, "%s: %s\n", argv[0], error.c_str());
+      return 1;
+   }
+
+   daemonPtr = &daemon;
+   signal(SIGINT, stopDaemon);
+   signal(SIGTERM, stopDaemon);
+   signal(SIGPIPE, SIG_IGN);
+   daemon.serve();
+   daemonPtr = NULL;
+
+   fprintf(stderr, "%ld requests answered, %ld block sets loaded\n",
+           daemon.getRequestCount(), daemon.getLoadCount());
+   return 0;
+}
@@ -0,0 +1,306 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "block_puzzle_solve.cpp" - Main function of command line solver "block_puzzle_solve".           *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "puzzle.h"
+
+/*
+ * Headless view: progress messages go to stderr (unless 'quiet'),
+ * the report at the end of a solve to stdout.
+ */
+class consoleView : public puzzleView {
+ public:
+   consoleView(bool q) : quiet(q) {}
+
+   void setGridSize(int, int) {}
+   void drawSquare(COLORREF, int, int) {}
+   void drawText(const char *text) {
+      if (!quiet)
+        fprintf(stderr, "\r%-50s\r", text);
+   }
+   void showMessage(const char *text) {printf("%s\n", text);}
+   bool idle(void) {return true;}
+
+ private:
+   bool quiet;
+};
+
+/*
+ * Draws the puzzle grid in a terminal (on stderr) with ANSI colour
+ * escapes, two characters to a square, each run of squares drawn (see
+ * "puzzleView::beginDraw") over the last, with the latest text beneath.
+ * Used to watch a search (see "searchWatcher") or replay a trace.
+ */
+class terminalView : public puzzleView {
+ public:
+   terminalView(void) {height = width = batching = 0; shown = false;}
+
+   void setGridSize(int h, int w) {
+      height = h;
+      width  = w;
+      squares.assign(h * w, RGB(0, 0, 0));
+   }
+   void drawSquare(COLORREF colour, int r, int c) {
+      squares[r * width + c] = colour;
+      if (batching == 0)
+        show();
+   }
+   void beginDraw(void) {++batching;}
+   void endDraw(void) {
+      if (--batching == 0)
+        show();
+   }
+   void drawText(const char *t) {text = t;}
+   void showMessage(const char *t) {printf("%s\n", t);}
+   bool idle(void) {return true;}
+
+ private:
+   void show(void) {
+      std::string out;
+      char buffer[32];
+      if (shown) {
+         sprintf(buffer, "\x1b[%dA", height + 1); // back to top of grid
+         out += buffer;
+      }
+      for (int r = 0; r < height; ++r) {
+         for (int c = 0; c < width; ++c) {
+            COLORREF colour = squares[r * width + c];
+            sprintf(buffer, "\x1b[48;2;%d;%d;%dm  ",
+                    (int)(colour & 0xff), (int)((colour >> 8) & 0xff), (int)((colour >> 16) & 0xff));
+            out += buffer;
+         }
+         out += "\x1b[0m\n";
+      }
+      out += text + "\x1b[K\n";
+      fputs(out.c_str(), stderr);
+      shown = true;
+   }
+
+   int  height,
+        width,
+        batching;
+   bool shown; // grid has been drawn (so is to be drawn over)
+   std::vector<COLORREF> squares;
+   std::string text;
+};
+
+static void usage(const char *program) {
+   fprintf(stderr,
+           "usage: %s [options]\n"
+           "  --blocks FILE       block set to solve (default default_block_set.blk)\n"
+           "  --board FILE        puzzle grid to fill (see board.h, default 8 x 8)\n"
+           "  --out FILE          file solutions are written to (default " DEFAULT_SOLUTION_FILE ")\n"
+           "  --format FORMAT     'binary' (default) or 'text' solution file\n"
+           "  --engine NAME       'backtrack' (default) or 'dlx' (exact cover)\n"
+           "  --threads N         threads used by backtracking engine (0 = all processors)\n"
+           "  --split-depth N     blocks placed before search is split between threads\n"
+           "  --prune             abandon placements leaving unfillable regions\n"
+           "  --break-symmetry    find only one of each set of symmetric solutions\n"
+           "  --expand-symmetry   with --break-symmetry, still write every solution\n"
+           "  --limit N           stop after first N solutions\n"
+           "  --count-only        count solutions, do not write them\n"
+           "  --cache MB          cache results of searches below states met (single thread)\n"
+           "  --cache-policy P    'cheapest' (default) or 'oldest' entries replaced when full\n"
+           "  --estimate N        estimate size of search from N random paths, do not solve\n"
+           "  --view N            print solution N as text after solving\n"
+           "  --no-solve          do not solve, only --view solution in existing --out file\n"
+           "  --stats             print search statistics (if compiled in) after solving\n"
+           "  --watch             draw the search in the terminal as it runs (single thread)\n"
+           "  --trace FILE        record what the search is doing to FILE (single thread)\n"
+           "  --rate N            snapshots of the search drawn/recorded a second (default 30)\n"
+           "  --replay FILE       draw a recorded trace in the terminal instead of solving\n"
+           "  --speed X           replay X times as fast as recorded (default 1, 0 = no delay)\n"
+           "  --quiet             do not report progress\n",
+           program);
+}
+
+int main(int argc, char *argv[]) {
+   const char *blockFile = "default_block_set.blk",
+              *boardFile = NULL,
+              *outFile   = DEFAULT_SOLUTION_FILE;
+   const char *traceFile  = NULL,
+              *replayFile = NULL;
+   bool quiet   = false,
+        stats   = false,
+        noSolve = false,
+        watch   = false;
+   int  viewNo = 0,
+        probes = 0,
+        i;
+   double rate  = SNAPSHOT_RATE,
+          speed = 1;
+   puzzle puz;
+
+   for (i = 1; i < argc; ++i) {
+      const char *arg = argv[i],
+                 *val = i + 1 < argc ? argv[i + 1] : NULL;
+      if (strcmp(arg, "--prune") == 0)
+        puz.setPruning(true);
+      else if (strcmp(arg, "--break-symmetry") == 0)
+        puz.setBreakSymmetry(true);
+      else if (strcmp(arg, "--expand-symmetry") == 0)
+        puz.setExpandSymmetry(true);
+      else if (strcmp(arg, "--quiet") == 0)
+        quiet = true;
+      else if (strcmp(arg, "--stats") == 0)
+        stats = true;
+      else if (strcmp(arg, "--no-solve") == 0)
+        noSolve = true;
+      else if (strcmp(arg, "--watch") == 0)
+        watch = true;
+      else if (strcmp(arg, "--count-only") == 0)
+        puz.setCountOnly(true);
+      else if (strcmp(arg, "--help") == 0) {
+         usage(argv[0]);
+         return 0;
+      }
+      else if (val == NULL) {
+         usage(argv[0]);
+         return 2;
+      }
+      else {
+         ++i; // options below take a value
+         if (strcmp(arg, "--blocks") == 0)
+           blockFile = val;
+         else if (strcmp(arg, "--board") == 0)
+           boardFile = val;
+         else if (strcmp(arg, "--out") == 0)
+           outFile = val;
+         else if (strcmp(arg, "--format") == 0 && strcmp(val, "binary") == 0)
+           puz.setSolutionFormat(BINARY_SOLUTIONS);
+         else if (strcmp(arg, "--format") == 0 && strcmp(val, "text") == 0)
+           puz.setSolutionFormat(TEXT_SOLUTIONS);
+         else if (strcmp(arg, "--engine") == 0 && strcmp(val, "backtrack") == 0)
+           puz.setEngine(BACKTRACKING_ENGINE);
+         else if (strcmp(arg, "--engine") == 0 && strcmp(val, "dlx") == 0)
+           puz.setEngine(EXACT_COVER_ENGINE);
+         else if (strcmp(arg, "--threads") == 0)
+           puz.setThreads(atoi(val) > 0 ? atoi(val) : workStealingPool::hardwareThreads());
+         else if (strcmp(arg, "--split-depth") == 0)
+           puz.setSplitDepth(atoi(val));
+         else if (strcmp(arg, "--view") == 0)
+           viewNo = atoi(val);
+         else if (strcmp(arg, "--estimate") == 0)
+           probes = atoi(val) > 0 ? atoi(val) : ESTIMATE_PROBES;
+         else if (strcmp(arg, "--cache") == 0)
+           puz.setCache((size_t)(atof(val) * 1024 * 1024), puz.getCachePolicy());
+         else if (strcmp(arg, "--cache-policy") == 0 && strcmp(val, "cheapest") == 0)
+           puz.setCache(puz.getCacheSize(), REPLACE_CHEAPEST);
+         else if (strcmp(arg, "--cache-policy") == 0 && strcmp(val, "oldest") == 0)
+           puz.setCache(puz.getCacheSize(), REPLACE_OLDEST);
+         else if (strcmp(arg, "--limit") == 0)
+           puz.setSolutionLimit(atol(val));
+         else if (strcmp(arg, "--trace") == 0)
+           traceFile = val;
+         else if (strcmp(arg, "--rate") == 0)
+           rate = atof(val);
+         else if (strcmp(arg, "--replay") == 0)
+           replayFile = val;
+         else if (strcmp(arg, "--speed") == 0)
+           speed = atof(val) > 0 ? atof(val) : 0;
+         else {
+            usage(argv[0]);
+            return 2;
+         }
+      }
+   }
+
+   consoleView view(quiet || watch); // progress would be drawn over
+   puz.setView(&view);
+   puz.setEstimateProgress(!quiet && !watch); // time remaining shown with progress
+   terminalView terminal;
+   searchWatcher watcher;
+   if (watch || traceFile != NULL) {
+      if (watch)
+        watcher.setView(&terminal);
+      if (traceFile != NULL)
+        watcher.setTraceFile(traceFile);
+      watcher.setRate(rate);
+      puz.setWatcher(&watcher);
+   }
+   puz.setSolutionFile(outFile);
+
+   if (boardFile != NULL && !puz.readBoard(boardFile)) {
+      fprintf(stderr, "%s: cannot read board \"%s\"\n", argv[0], boardFile);
+      return 1;
+   }
+   if (!puz.readBlockSet(blockFile)) {
+      fprintf(stderr, "%s: %s\n", argv[0], puz.getReadError().c_str());
+      return 1;
+   }
+
+   if (replayFile != NULL) {
+      puz.setView(&terminal);
+      long frames = puz.replayTrace(replayFile, speed);
+      if (frames < 0) {
+         fprintf(stderr, "%s: cannot replay \"%s\" (not a trace of this block set and board)\n",
+                 argv[0], replayFile);
+         return 1;
+      }
+      printf("%ld snapshots replayed.\n", frames);
+      return 0;
+   }
+
+   if (probes > 0) {
+      double nodes, solutions, seconds;
+      puz.estimate(probes, nodes, solutions, seconds);
+      printf("Estimated from %d random paths:\n"
+             "  search nodes  %.3g\n"
+             "  solutions     %.3g\n"
+             "  time taken    %.3g seconds\n",
+             probes, nodes, solutions, seconds);
+      return 0;
+   }
+
+   long long solutionCount;
+   if (noSolve) {
+      solutionCount = puz.countSolutions();
+      if (solutionCount < 0) {
+         fprintf(stderr, "%s: cannot read \"%s\"\n", argv[0], outFile);
+         return 1;
+      }
+      if (!quiet)
+        printf("%lld solutions in \"%s\".\n", solutionCount, outFile);
+   }
+   else {
+      solutionCount = puz.solve();
+      if (solutionCount < 0) {
+         fprintf(stderr, "%s: cannot write \"%s\"\n", argv[0], outFile);
+         return 1;
+      }
+   }
+
+   if (stats && !noSolve) {
+      std::cout << std::endl;
+      puz.getStats().report(std::cout);
+      printf("\nplacements: %d (%.1f MB)\n", puz.getPlacementCount(),
+             puz.getPlacementBytes() / (1024.0 * 1024.0));
+      if (puz.getCacheSize() > 0) {
+         const cacheStats &c = puz.getCacheStats();
+         printf("\ncache: %ld hits, %ld misses, %ld stores, %ld evictions, %ld dropped\n",
+                c.hits, c.misses, c.stores, c.evictions, c.dropped);
+      }
+   }
+
+   if (viewNo > 0 && viewNo <= solutionCount && !puz.getCountOnly()) {
+      puz.setView(NULL);
+      if (!puz.viewSolution(viewNo, true)) {
+         fprintf(stderr, "%s: cannot read solution %d from \"%s\"\n", argv[0], viewNo, outFile);
+         return 1;
+      }
+      std::cout << "Solution " << viewNo << ":" << std::endl;
+      puz.print(std::cout);
+   }
+   return 0;
+}
@@ -0,0 +1,313 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "blockset.cpp" - Member functions of class "blockSet", and block set file parser (see          *
+*                  "blockset.h").                                                                 *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "blockset.h"
+
+using namespace std;
+
+/*
+ * Moves through the text of a block set a byte at a time, keeping track
+ * of line and column for error messages.
+ */
+class blockSetCursor {
+ public:
+   blockSetCursor(const char *data, size_t size, const char *n)
+     : p(data), end(data + size), lineStart(data), name(n) {line = 1;}
+
+   bool atEnd(void) const    {return p == end;    }
+   char peek(void) const     {return *p;          }
+   int  getLine(void) const  {return line;        }
+   int  getColumn(void) const {return (int)(p - lineStart) + 1;}
+
+   void skipSpaces(void) {
+      while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+   }
+
+   // move past end of line (if there), returning false if not at one
+   bool endLine(void) {
+      skipSpaces();
+      if (p == end)
+        return true;
+      if (*p != '\n')
+        return false;
+      lineStart = ++p;
+      ++line;
+      return true;
+   }
+
+   // move past blank lines, stopping at start of next line with text
+   void skipBlankLines(void) {
+      for (;;) {
+         const char *q = p;
+         while (q < end && (*q == ' ' || *q == '\t' || *q == '\r'))
+           ++q;
+         if (q == end || *q != '\n') {
+            if (q == end)
+              p = q;
+            return;
+         }
+         lineStart = p = q + 1;
+         ++line;
+      }
+   }
+
+   // read number of up to 9 digits, returning -1 if there is none
+   long number(void) {
+      if (p == end || *p < '0' || *p > '9')
+        return -1;
+      long n = 0;
+      for (int digits = 0; p < end && *p >= '0' && *p <= '9'; ++digits, ++p)
+        n = digits < 9 ? n * 10 + (*p - '0') : 1000000000L;
+      return n;
+   }
+
+   void next(void) {++p;}
+
+   // set 'error' to message at 'l', 'c', returning false
+   bool fail(string &error, int l, int c, const char *format, ...) {
+      char buffer[200];
+      va_list args;
+      va_start(args, format);
+      vsnprintf(buffer, sizeof(buffer), format, args);
+      va_end(args);
+      char where[32];
+      sprintf(where, ":%d:%d: ", l, c);
+      error = string(name) + where + buffer;
+      return false;
+   }
+
+ private:
+   const char *p,
+              *end,
+              *lineStart;
+   const char *name;
+   int line;
+};
+
+/*
+ * Describe character 'ch' for an error message.
+ */
+static string describe(const char ch) {
+   char buffer[16];
+   if (ch >= ' ' && ch < 127)
+     sprintf(buffer, "'%c'", ch);
+   else
+     sprintf(buffer, "byte 0x%02x", (unsigned char)ch);
+   return buffer;
+}
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Append block of colour 'colour', 'h' x 'w' squares.  Its grid goes on
+ * the end of the grids in the pool, dropping the masks after them.
+ */
+void blockSet::add(const COLORREF colour, const int h, const int w, const vector<bool> &squares,
+                   const pos hold) {
+   size_t side  = h > w ? h : w,
+          start = gridBytes;
+   gridBytes += side * side;
+   pool.resize((gridBytes + sizeof(bbWord) - 1) / sizeof(bbWord));
+   blocks.emplace_back();
+   attachGrids(); // pool may have moved
+   block &b = blocks.back();
+   b.setColour(colour);
+   b.setShape(h, w, squares, hold, (unsigned char *)pool.data() + start);
+}
+
+/*
+ * Remove blocks 'n' onwards, and their grids.
+ */
+void blockSet::truncate(const int n) {
+   blocks.resize(n);
+   gridBytes = 0;
+   for (int i = 0; i < n; ++i)
+     gridBytes += blocks[i].side * blocks[i].side;
+   pool.resize((gridBytes + sizeof(bbWord) - 1) / sizeof(bbWord));
+   attachGrids();
+}
+
+/*
+ * Build masks of every block on the end of the pool, after measuring
+ * them all so that the pool is resized once.
+ */
+void blockSet::buildMasks(const int puzzleWidth) {
+   size_t gridWords = (gridBytes + sizeof(bbWord) - 1) / sizeof(bbWord),
+          words     = gridWords;
+   int    i;
+   for (i = 0; i < (int)blocks.size(); ++i)
+     words += blocks[i].measureMasks(puzzleWidth);
+   pool.resize(gridWords);
+   pool.resize(words, 0);
+   attachGrids(); // pool may have moved
+
+   words = gridWords;
+   for (i = 0; i < (int)blocks.size(); ++i) {
+      blocks[i].buildMasks(puzzleWidth, &pool[words]);
+      words += blocks[i].maskStart[8];
+   }
+}
+
+/*
+ * Parse block set 'data[0..size-1]', appending its blocks to 'blocks'.
+ */
+bool parseBlockSet(const char *data, const size_t size, const char *name,
+                   blockSet &blocks, string &error) {
+   blockSetCursor in(data, size, name);
+   int first = blocks.size();
+   vector<bool> squares; // of block being read, row by row
+
+   in.skipBlankLines();
+   while (!in.atEnd()) {
+      int blockLine = in.getLine();
+      if (blocks.size() - first == MAX_NUMBER_BLOCKS) {
+         blocks.truncate(first);
+         return in.fail(error, blockLine, 1, "more than %d blocks", MAX_NUMBER_BLOCKS);
+      }
+
+      // colour
+      int rgb[3], k;
+      for (k = 0; k < 3; ++k) {
+         in.skipSpaces();
+         int column = in.getColumn();
+         long n = in.number();
+         if (n < 0 || n > 255) {
+            blocks.truncate(first);
+            if (n < 0)
+              return in.fail(error, in.getLine(), column,
+                             "expected colour (red, green and blue from 0 to 255), found %s",
+                             in.atEnd() || in.peek() == '\n' ? "end of line"
+                                                            : describe(in.peek()).c_str());
+            return in.fail(error, in.getLine(), column, "colour %ld is not from 0 to 255", n);
+         }
+         rgb[k] = (int)n;
+      }
+      if (!in.endLine()) {
+         blocks.truncate(first);
+         return in.fail(error, in.getLine(), in.getColumn(), "unexpected %s after colour",
+                        describe(in.peek()).c_str());
+      }
+      in.skipBlankLines();
+
+      // rows of squares, up to blank line or end of file
+      int width = 0, height = 0, holdLine = 0, holdColumn = 0, topLine = in.getLine();
+      pos hold = {-1, -1};
+      squares.clear();
+      while (!in.atEnd() && in.peek() != '\n' && in.peek() != '\r') {
+         int rowLine = in.getLine(), c = 0;
+         for (; !in.atEnd(); ++c, in.next()) {
+            char ch = in.peek();
+            if (ch == '2') {
+               if (hold.r != -1) {
+                  blocks.truncate(first);
+                  return in.fail(error, rowLine, in.getColumn(),
+                                 "second hold square '2' in block (first at line %d column %d)",
+                                 holdLine, holdColumn);
+               }
+               hold.r     = height;
+               hold.c     = c;
+               holdLine   = rowLine;
+               holdColumn = in.getColumn();
+            }
+            else if (ch != '0' && ch != '1')
+              break;
+            squares.push_back(ch != '0');
+         }
+         int  column = in.getColumn();
+         char stop   = in.atEnd() ? '\n' : in.peek();
+         if (!in.endLine()) {
+            if (stop == ' ' || stop == '\t' || stop == '\r') {
+               column = in.getColumn(); // text after spaces
+               stop   = in.peek();
+            }
+            blocks.truncate(first);
+            return in.fail(error, rowLine, column,
+                           "unexpected %s in block (squares are '0', '1' or '2')",
+                           describe(stop).c_str());
+         }
+         if (c == 0)
+           break; // line of spaces ends block
+         if (height == 0)
+           width = c;
+         else if (c != width) {
+            blocks.truncate(first);
+            return in.fail(error, rowLine, 1, "row is %d squares wide, first row of block is %d",
+                           c, width);
+         }
+         if (c > MAX_BLOCK_SIDE || ++height > MAX_BLOCK_SIDE) {
+            blocks.truncate(first);
+            return in.fail(error, rowLine, 1, "block is more than %d squares %s", MAX_BLOCK_SIDE,
+                           c > MAX_BLOCK_SIDE ? "wide" : "high");
+         }
+      }
+      if (height == 0) {
+         blocks.truncate(first);
+         return in.fail(error, in.getLine(), 1, "block has no rows of squares");
+      }
+      if (hold.r == -1) {
+         blocks.truncate(first);
+         return in.fail(error, blockLine, 1, "block has no hold square '2'");
+      }
+      for (k = 0; k < width && !squares[k]; ++k);
+      if (k == width) {
+         blocks.truncate(first);
+         return in.fail(error, topLine, 1, "top row of block has no square");
+      }
+
+      blocks.add(RGB(rgb[0], rgb[1], rgb[2]), height, width, squares, hold);
+      in.skipBlankLines();
+   }
+   if (blocks.size() == first)
+     return in.fail(error, in.getLine(), 1, "no blocks in block set");
+   return true;
+}
+
+/*
+ * Parse block set file 'fileName'.
+ */
+bool readBlockSetFile(const char *fileName, blockSet &blocks, string &error) {
+   FILE *file = fopen(fileName, "rb");
+   if (file == NULL) {
+      error = string(fileName) + ": cannot open file";
+      return false;
+   }
+
+   // block sets are small: one read of the whole file is cheaper than mapping it
+   string data;
+   long size = -1;
+   if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0) {
+      data.resize((size_t)size);
+      data.resize(fread(&data[0], 1, data.size(), file));
+   }
+   bool failed = size < 0 || ferror(file) != 0;
+   fclose(file);
+   if (failed) {
+      error = string(fileName) + ": cannot read file";
+      return false;
+   }
+   return parseBlockSet(data.data(), data.size(), fileName, blocks, error);
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Point each block at its grid in the pool (and none at any masks).
+ */
+void blockSet::attachGrids(void) {
+   unsigned char *g = (unsigned char *)pool.data();
+   for (int i = 0; i < (int)blocks.size(); ++i) {
+      blocks[i].grid  = g;
+      blocks[i].masks = NULL;
+      g += blocks[i].side * blocks[i].side;
+   }
+}
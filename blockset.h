@@ -0,0 +1,95 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "blockset.h" - Class "blockSet" definition, and block set file parser.                          *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef BLOCKSET_H
+#define BLOCKSET_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "block.h"
+
+/*
+ * A block set file (.blk) holds up to MAX_NUMBER_BLOCKS blocks separated
+ * by blank lines.  Each block is a line giving its colour as three
+ * numbers from 0 to 255 (red, green, blue), then one line per row of its
+ * squares, every row as wide as the first:
+ *
+ *    '0'  no square
+ *    '1'  square
+ *    '2'  square held by the mouse pointer when the block is picked up
+ *         (exactly one in each block)
+ *
+ * The top row must have a square.  Lines may end "\r\n".  eg.
+ *
+ *    250 240 200
+ *    11100
+ *    00200
+ *    00111
+ */
+
+/*
+ * The blocks of a block set (block 'i' is "blocks[i]"), with the grids
+ * and occupancy masks of all of them held one after another in a single
+ * pool: the grids first, then the masks of each block in turn.
+ */
+class blockSet {
+ public:
+   blockSet(void) {gridBytes = 0;}
+
+   int   size(void) const       {return (int)blocks.size();}
+   block *data(void)            {return blocks.data();     }
+   block &operator[](const int i) {return blocks[i];       }
+
+   /*
+    * Append block 'h' x 'w' squares (see "block::setShape") of colour
+    * 'colour'.  Masks of all blocks must be built again after.
+    */
+   void add(COLORREF colour, int h, int w, const std::vector<bool> &squares, pos hold);
+
+   /*
+    * Remove blocks 'n' onwards.
+    */
+   void truncate(int n);
+
+   /*
+    * Build occupancy masks of every block for a puzzle grid "puzzleWidth"
+    * squares wide (see "block::buildMasks").
+    */
+   void buildMasks(int puzzleWidth);
+
+   void swap(blockSet &s) {blocks.swap(s.blocks); pool.swap(s.pool); std::swap(gridBytes, s.gridBytes);}
+
+ private:
+   blockSet(const blockSet &);            // not copyable (blocks point into 'pool')
+   blockSet &operator=(const blockSet &);
+
+   void attachGrids(void);
+
+   std::vector<block>  blocks;
+   std::vector<bbWord> pool;      // grids of blocks, then masks of blocks
+   size_t              gridBytes; // bytes of 'pool' holding grids
+};
+
+/*
+ * Parse block set 'data[0..size-1]', appending its blocks to 'blocks'
+ * (each built in place, in orientation 0).  Return false on the first
+ * mistake found, leaving 'blocks' as it was and setting 'error' to
+ * "name:line:column: what is wrong".
+ */
+bool parseBlockSet(const char *data, size_t size, const char *name,
+                   blockSet &blocks, std::string &error);
+
+/*
+ * Parse block set file 'fileName' (read whole into one buffer) as
+ * "parseBlockSet" does.
+ */
+bool readBlockSetFile(const char *fileName, blockSet &blocks, std::string &error);
+
+#endif
@@ -0,0 +1,79 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "board.cpp" - Member functions of class "board" (defined in "board.h").                         *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+using namespace std;
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Constructor.  Rectangular board of 'h' x 'w' open squares.
+ */
+board::board(const int h, const int w) {
+   assert(h > 0 && h <= MAX_PUZZLE_HEIGHT && w > 0 && w <= MAX_PUZZLE_WIDTH);
+   height = h;
+   width  = w;
+   squares.assign(height * width, OPEN_SQUARE);
+}
+
+/*
+ * Return number of open squares.
+ */
+int board::getOpenCount(void) const {
+   int n = 0;
+   for (int r = 0; r < height; ++r)
+     for (int c = 0; c < width; ++c)
+       if (getSquare(r, c) == OPEN_SQUARE)
+         ++n;
+   return n;
+}
+
+// FRIEND FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Read board from 'input'.
+ */
+istream &operator>>(istream &input, board &b) {
+   vector<string> rows;
+   string line;
+   int width = 0, open = 0, r, c;
+
+   while (getline(input, line)) {
+      if (!line.empty() && line[line.size() - 1] == '\r')
+        line.erase(line.size() - 1); // file written on Windows
+      if (line.empty() || line[0] == ';')
+        continue;
+      for (c = 0; c < (int)line.size(); ++c)
+        if (line[c] == '.')
+          ++open;
+        else if (line[c] != '#' && line[c] != ' ') {
+           input.setstate(ios::failbit);
+           return input;
+        }
+      if ((int)line.size() > width)
+        width = (int)line.size();
+      rows.push_back(line);
+   }
+   if (open == 0 || (int)rows.size() > MAX_PUZZLE_HEIGHT || width > MAX_PUZZLE_WIDTH) {
+      input.setstate(ios::failbit);
+      return input;
+   }
+
+   b = board((int)rows.size(), width);
+   for (r = 0; r < b.height; ++r)
+     for (c = 0; c < b.width; ++c) {
+        char ch = c < (int)rows[r].size() ? rows[r][c] : ' ';
+        b.squares[r * b.width + c] = ch == '.' ? OPEN_SQUARE : ch == '#' ? BLOCKED_SQUARE : OUTSIDE_SQUARE;
+     }
+   input.clear(ios::eofbit);
+   return input;
+}
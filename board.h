@@ -0,0 +1,81 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "board.h" - Class "board" definition.                                                           *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <iostream>
+#include <vector>
+#include <assert.h>
+
+#include "bitboard.h"
+
+#define DEFAULT_BOARD_SIZE 8 // board is 8 x 8 squares unless one is read from file
+
+/*
+ * Kinds of square in a board.  Only open squares are filled by blocks;
+ * blocked squares (holes and squares filled before the puzzle starts)
+ * and squares outside the outline of a non-rectangular board are
+ * simply occupied from the start.
+ */
+enum boardSquare {OPEN_SQUARE, BLOCKED_SQUARE, OUTSIDE_SQUARE};
+
+/*
+ * Shape of a puzzle grid, up to MAX_PUZZLE_HEIGHT x MAX_PUZZLE_WIDTH
+ * squares.  A board file has one line per row of squares:
+ *
+ *    '.'  open square
+ *    '#'  blocked square
+ *    ' '  square outside board (rows shorter than the longest are
+ *         padded with these)
+ *
+ * Lines starting with ';' are comments and blank lines are ignored.
+ * eg. an 8 x 8 board with its centre blocked
+ *
+ *    ; centre blocked
+ *    ........
+ *    ........
+ *    ........
+ *    ...##...
+ *    ...##...
+ *    ........
+ *    ........
+ *    ........
+ */
+class board {
+   friend std::istream &operator>>(std::istream &, board &);
+
+ public:
+   /*
+    * Rectangular board of 'h' x 'w' open squares.
+    */
+   board(int h = DEFAULT_BOARD_SIZE, int w = DEFAULT_BOARD_SIZE);
+
+   int getHeight(void) const {return height;}
+   int getWidth(void) const  {return width; }
+   boardSquare getSquare(int r, int c) const {return squares[r * width + c];}
+
+   /*
+    * Return number of open squares.
+    */
+   int getOpenCount(void) const;
+
+ private:
+   int height,
+       width;
+   std::vector<boardSquare> squares; // square (r, c) is squares[r * width + c]
+};
+
+/*
+ * Read board from 'input' (see "board").  Sets failbit, leaving 'b'
+ * unchanged, if the board is empty, too large, has no open squares or
+ * contains a character other than those above.
+ */
+std::istream &operator>>(std::istream &input, board &b);
+
+#endif
@@ -0,0 +1,147 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "cache.h" - Class template "transpositionCache" definition.                                     *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <vector>
+
+#include "bitboard.h"
+
+#define CACHE_WAYS     4 // entries per bucket
+#define CACHE_MIN_WORK 8 // nodes a search below a state must take for it to be stored
+
+/*
+ * Choice of entry replaced when a state is stored in a full bucket.
+ * REPLACE_OLDEST replaces the entry stored longest ago.  REPLACE_CHEAPEST
+ * replaces the entry whose search took fewest nodes, or keeps the bucket
+ * as it is if the new state's search took fewer still.
+ */
+enum cacheReplacement {REPLACE_OLDEST, REPLACE_CHEAPEST};
+
+/*
+ * Hit/miss counts of a "transpositionCache".
+ */
+struct cacheStats {
+   long hits,      // states found
+        misses,    // states not found
+        stores,    // states stored
+        evictions, // entries replaced by another state
+        dropped;   // states not stored as bucket held costlier ones
+};
+
+/*
+ * Results of searches below states of a backtracking search, so that a
+ * state reached again by placing the same blocks in another order is not
+ * searched again.  A state is the squares occupied and the blocks used,
+ * and its result the number of solutions below it (0 for a dead state)
+ * and the nodes it took to find them.
+ *
+ * The table has a fixed size (set in bytes by the constructor) and is
+ * split into buckets of CACHE_WAYS entries.  A state is stored only in
+ * the bucket its hash selects, replacing an entry (see "cacheReplacement")
+ * if the bucket is full.
+ */
+template <int WORDS>
+class transpositionCache {
+ public:
+   transpositionCache(const size_t bytes, const cacheReplacement r) : policy(r) {
+      size_t buckets = 1;
+      while (2 * buckets * CACHE_WAYS * sizeof(entry) <= bytes)
+        buckets *= 2;
+      bucketMask = buckets - 1;
+      entries.assign(bytes >= CACHE_WAYS * sizeof(entry) ? buckets * CACHE_WAYS : 0, entry());
+      clock = 0;
+      stats.hits = stats.misses = stats.stores = stats.evictions = stats.dropped = 0;
+   }
+
+   /*
+    * Look up state 'occ', 'used'.  Return true and set 'solutions' if found.
+    */
+   bool find(const bitboard<WORDS> &occ, const blockMask used, long &solutions) {
+      if (entries.empty())
+        return false;
+      entry *e = &entries[bucketOf(occ, used)];
+      for (int i = 0; i < CACHE_WAYS; ++i)
+        if (e[i].stamp != 0 && e[i].used == used && e[i].occ == occ) {
+           ++stats.hits;
+           solutions = e[i].solutions;
+           return true;
+        }
+      ++stats.misses;
+      return false;
+   }
+
+   /*
+    * Store result of complete search below state 'occ', 'used': the
+    * number of 'solutions' and the number of nodes it took ('work').
+    */
+   void store(const bitboard<WORDS> &occ, const blockMask used,
+              const long solutions, const long work) {
+      if (entries.empty() || work < CACHE_MIN_WORK)
+        return;
+      entry *e = &entries[bucketOf(occ, used)], *victim = e;
+      for (int i = 0; i < CACHE_WAYS; ++i) {
+         if (e[i].stamp == 0) {
+            victim = &e[i];
+            break;
+         }
+         if (policy == REPLACE_OLDEST ? e[i].stamp < victim->stamp : e[i].work < victim->work)
+           victim = &e[i];
+      }
+      if (victim->stamp != 0) {
+         if (policy == REPLACE_CHEAPEST && work < victim->work) {
+            ++stats.dropped;
+            return;
+         }
+         ++stats.evictions;
+      }
+      victim->occ       = occ;
+      victim->used      = used;
+      victim->solutions = solutions;
+      victim->work      = work;
+      victim->stamp     = ++clock;
+      ++stats.stores;
+   }
+
+   const cacheStats &getStats(void) const {return stats;}
+
+   /*
+    * Return number of bytes used by the table.
+    */
+   size_t getBytes(void) const {return entries.size() * sizeof(entry);}
+
+ private:
+   struct entry {
+      entry(void) {stamp = 0;}
+      bitboard<WORDS> occ;
+      blockMask used;
+      long solutions,
+           work;
+      unsigned long stamp; // order stored (0 = empty)
+   };
+
+   // index of first entry of bucket state hashes to
+   size_t bucketOf(const bitboard<WORDS> &occ, const blockMask used) const {
+      unsigned long long h = used * 0x9e3779b97f4a7c15ULL;
+      for (int i = 0; i < WORDS; ++i) {
+         h ^= occ.word(i);
+         h *= 0xff51afd7ed558ccdULL;
+         h ^= h >> 32;
+      }
+      return (size_t)(h & bucketMask) * CACHE_WAYS;
+   }
+
+   cacheReplacement policy;
+   std::vector<entry> entries;
+   size_t bucketMask;
+   unsigned long clock; // stamp of last entry stored
+   cacheStats stats;
+};
+
+#endif
@@ -0,0 +1,162 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "checker.cpp" - Member functions of class "solvabilityChecker" (defined in "checker.h").        *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include "checker.h"
+
+using namespace std;
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Constructor.
+ */
+solvabilityChecker::solvabilityChecker(void) {
+   version  = 0;
+   waiting  = false;
+   quitting = false;
+   stale    = false;
+   puz.setCountOnly(true);
+   puz.setPruning(true);
+   puz.setCache(CHECKER_CACHE_BYTES, REPLACE_CHEAPEST);
+   puz.setKeepCache(true);
+   puz.setCancelFlag(&stale);
+}
+
+/*
+ * Destructor.
+ */
+solvabilityChecker::~solvabilityChecker(void) {
+   halt();
+}
+
+/*
+ * Check puzzles of block set 'blockFile' on board 'b'.
+ */
+bool solvabilityChecker::load(const char *blockFile, const board &b) {
+   halt();
+   puz.setBoard(b);
+   bool ok = puz.readBlockSet(blockFile);
+   if (ok)
+     start();
+   return ok;
+}
+
+/*
+ * Check state 'pieces' next.
+ */
+long solvabilityChecker::update(const vector<piecePlacement> &pieces) {
+   lock_guard<mutex> guard(lock);
+   pending = pieces;
+   waiting = true;
+   given   = chrono::steady_clock::now();
+   stale   = true; // stop search of previous state
+   changed.notify_one();
+   return ++version;
+}
+
+/*
+ * Stop work on the current state.
+ */
+void solvabilityChecker::cancel(void) {
+   lock_guard<mutex> guard(lock);
+   waiting = false;
+   stale   = true;
+   ++version;
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Start worker thread.
+ */
+void solvabilityChecker::start(void) {
+   quitting = false;
+   worker = thread(&solvabilityChecker::workerMain, this);
+}
+
+/*
+ * Stop worker thread (if running).
+ */
+void solvabilityChecker::halt(void) {
+   if (!worker.joinable())
+     return;
+   {
+      lock_guard<mutex> guard(lock);
+      quitting = true;
+      stale    = true;
+   }
+   changed.notify_one();
+   worker.join();
+}
+
+/*
+ * Check each state given in turn, skipping those replaced while waiting.
+ */
+void solvabilityChecker::workerMain(void) {
+   for (;;) {
+      vector<piecePlacement> pieces;
+      long v;
+      {
+         unique_lock<mutex> guard(lock);
+         changed.wait(guard, [this] {return quitting || waiting;});
+         if (quitting)
+           return;
+         pieces.swap(pending);
+         v       = version;
+         waiting = false;
+         stale   = false;
+      }
+      check(pieces, v);
+   }
+}
+
+/*
+ * Find whether state 'pieces' can be completed, then count its
+ * completions, passing each result to the handler unless the state is
+ * replaced first.
+ */
+void solvabilityChecker::check(const vector<piecePlacement> &pieces, const long v) {
+   checkResult r;
+   r.version     = v;
+   r.solvable    = false;
+   r.counted     = false;
+   r.completions = 0;
+   if (!puz.addPieces(pieces))
+     r.counted = true; // blocks overlap: no completions
+   else {
+      // first completion, or the whole search if there is none
+      puz.setSolutionLimit(1);
+      long n = puz.solve();
+      r.counted     = puz.getCompleted();
+      r.solvable    = n > 0;
+      r.completions = n;
+      if (!stale && r.solvable) {
+         {
+            lock_guard<mutex> guard(lock);
+            r.seconds = chrono::duration<double>(chrono::steady_clock::now() - given).count();
+         }
+         if (handler)
+           handler(r);
+
+         // every completion
+         puz.setSolutionLimit(0);
+         r.completions = puz.solve();
+         r.counted     = puz.getCompleted();
+      }
+      puz.removePieces((int)pieces.size());
+   }
+
+   {
+      lock_guard<mutex> guard(lock);
+      if (stale || v != version || (r.solvable && !r.counted))
+        return; // replaced (or stopped) before the result was known
+      r.seconds = chrono::duration<double>(chrono::steady_clock::now() - given).count();
+   }
+   if (handler)
+     handler(r);
+}
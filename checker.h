@@ -0,0 +1,98 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "checker.h" - Class "solvabilityChecker" definition.                                            *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef CHECKER_H
+#define CHECKER_H
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include "puzzle.h"
+
+#define CHECKER_CACHE_BYTES (64 * 1024 * 1024) // cache kept between checks (see "setKeepCache")
+
+/*
+ * What is known of the completions of one state of the puzzle.
+ */
+struct checkResult {
+   long   version;     // number "solvabilityChecker::update" returned for state
+   bool   solvable,    // state can be completed
+          counted;     // 'completions' is the number of completions (else a lower bound)
+   long   completions;
+   double seconds;     // since state was given to "update"
+};
+
+/*
+ * Works out on a background thread whether the current state of the
+ * puzzle (the blocks in the grid) can still be completed, and then in
+ * how many ways, while the user carries on.  Each state given to
+ * "update" stops any work on the one before.  The checker's own
+ * puzzle keeps its transposition cache between states (see
+ * "puzzle::setKeepCache"), so a state reached by adding or removing a
+ * block where an earlier state was counted is usually answered from the
+ * cache without searching.
+ *
+ * Each state gets one or two results: once it is known whether it can
+ * be completed (the first completion found, or the whole search if it
+ * cannot), and once its completions have been counted.
+ */
+class solvabilityChecker {
+ public:
+   solvabilityChecker(void);
+   ~solvabilityChecker(void);
+
+   /*
+    * Check puzzles of block set 'blockFile' on board 'b'.  Must be
+    * called before "update".  Return false if the file cannot be read.
+    */
+   bool load(const char *blockFile, const board &b);
+
+   /*
+    * Call 'f' with each result (on the checker's thread).
+    */
+   void setResultHandler(const std::function<void(const checkResult &)> &f) {handler = f;}
+
+   /*
+    * Check state 'pieces' (as "puzzle::getPieces" gives), stopping work
+    * on any earlier state.  Return number identifying the state in its
+    * results.
+    */
+   long update(const std::vector<piecePlacement> &pieces);
+
+   /*
+    * Stop work on the current state.
+    */
+   void cancel(void);
+
+ private:
+   solvabilityChecker(const solvabilityChecker &);            // not copyable
+   solvabilityChecker &operator=(const solvabilityChecker &);
+
+   void start(void);
+   void halt(void);
+   void workerMain(void);
+   void check(const std::vector<piecePlacement> &pieces, long version);
+
+   puzzle puz; // used only by worker thread while it runs
+   std::function<void(const checkResult &)> handler;
+   std::thread worker;
+   std::mutex lock; // guards members below
+   std::condition_variable changed;
+   std::vector<piecePlacement> pending; // state to check next
+   long version;                        // of latest state given
+   bool waiting,                        // 'pending' not yet taken by worker
+        quitting;
+   std::atomic<bool> stale; // state being checked has been replaced
+   std::chrono::steady_clock::time_point given; // when latest state was given
+};
+
+#endif
@@ -0,0 +1,28 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "colour.h" - Portable definition of "COLORREF" and "RGB".                                       *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef COLOUR_H
+#define COLOUR_H
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+/*
+ * Same layout as the Windows type (0x00bbggrr) so that colours written
+ * to solution files are identical on every platform.
+ */
+typedef unsigned long COLORREF;
+
+#define RGB(r, g, b) ((COLORREF)(((r) & 0xff) | (((g) & 0xff) << 8) | (((b) & 0xff) << 16)))
+
+#endif
+
+#endif
@@ -0,0 +1,445 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "daemon.cpp" - Member functions of class "solverDaemon" (defined in "daemon.h").                *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sstream>
+#include <algorithm>
+
+#include "daemon.h"
+#include "workpool.h"
+
+using namespace std;
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Constructor.  Block set and board files are read from 'dataDir'.
+ */
+solverDaemon::solverDaemon(const char *dataDir) : dataDir(dataDir) {
+   listenFd     = -1;
+   wakeFd[0]    = wakeFd[1] = -1;
+   workers      = workStealingPool::hardwareThreads();
+   maxPuzzles   = DAEMON_MAX_PUZZLES;
+   stopping     = false;
+   uses         = 0;
+   requestCount = 0;
+   loadCount    = 0;
+}
+
+/*
+ * Destructor.
+ */
+solverDaemon::~solverDaemon(void) {
+   if (listenFd >= 0) {
+      close(listenFd);
+      unlink(socketPath.c_str());
+   }
+   if (wakeFd[0] >= 0) {
+      close(wakeFd[0]);
+      close(wakeFd[1]);
+   }
+   for (int i = 0; i < (int)puzzles.size(); ++i) {
+      delete puzzles[i]->puz;
+      delete puzzles[i];
+   }
+}
+
+/*
+ * Listen for connections on socket 'path'.
+ */
+bool solverDaemon::listen(const char *path, string &error) {
+   sockaddr_un address;
+   if (strlen(path) >= sizeof(address.sun_path)) {
+      error = string("socket path too long \"") + path + "\"";
+      return false;
+   }
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   strcpy(address.sun_path, path);
+
+   if (pipe(wakeFd) != 0 || (listenFd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+      error = strerror(errno);
+      return false;
+   }
+   fcntl(wakeFd[1], F_SETFL, O_NONBLOCK);
+   unlink(path); // left by a daemon not stopped cleanly
+   if (bind(listenFd, (sockaddr *)&address, sizeof(address)) != 0
+       || ::listen(listenFd, SOMAXCONN) != 0) {
+      error = string("cannot listen on \"") + path + "\": " + strerror(errno);
+      close(listenFd);
+      listenFd = -1;
+      return false;
+   }
+   socketPath = path;
+   return true;
+}
+
+/*
+ * Answer requests until "stop" is called.
+ */
+void solverDaemon::serve(void) {
+   vector<shared_ptr<connection> > clients;
+   vector<pollfd> fds;
+   char buffer[4096];
+
+   for (int i = 0; i < workers; ++i)
+     threads.push_back(thread(&solverDaemon::workerMain, this));
+
+   for (;;) {
+      fds.clear();
+      pollfd p;
+      p.events = POLLIN;
+      p.fd     = wakeFd[0];
+      fds.push_back(p);
+      p.fd     = listenFd;
+      fds.push_back(p);
+      for (int i = 0; i < (int)clients.size(); ++i) {
+         p.fd = clients[i]->fd;
+         fds.push_back(p);
+      }
+      if (poll(&fds[0], fds.size(), -1) < 0) {
+         if (errno == EINTR)
+           continue;
+         break;
+      }
+      if (fds[0].revents != 0)
+        break; // "stop" called
+
+      if (fds[1].revents & POLLIN) {
+         int fd = accept(listenFd, NULL, NULL);
+         if (fd >= 0)
+           clients.push_back(make_shared<connection>(fd));
+      }
+
+      // read requests, dropping clients that have gone or sent too long a line
+      for (int i = (int)clients.size() - 1; i >= 0; --i) {
+         if (fds[i + 2].revents == 0)
+           continue;
+         connection &c = *clients[i];
+         ssize_t n = read(c.fd, buffer, sizeof(buffer));
+         if (n > 0) {
+            c.input.append(buffer, n);
+            readRequests(clients[i]);
+            if (c.input.size() <= DAEMON_MAX_LINE)
+              continue;
+            reply(c, "0 error request too long");
+         }
+         else if (n < 0 && errno == EINTR)
+           continue;
+         else if (n == 0 && !(fds[i + 2].revents & (POLLERR | POLLHUP))) {
+            // client has shut down its side after its last request: stop
+            // reading but answer what it sent (connection closed after)
+            if (!c.input.empty()) {
+               c.input += '\n';
+               readRequests(clients[i]);
+            }
+            clients.erase(clients.begin() + i);
+            continue;
+         }
+         shutdown(c.fd, SHUT_RD);
+         cancelRequests(clients[i].get(), 0, true);
+         clients.erase(clients.begin() + i);
+      }
+   }
+
+   // cancel everything and wait for workers
+   {
+      lock_guard<mutex> guard(lock);
+      stopping = true;
+      for (int i = 0; i < (int)running.size(); ++i)
+        running[i]->cancel = true;
+   }
+   ready.notify_all();
+   for (int i = 0; i < (int)threads.size(); ++i)
+     threads[i].join();
+   threads.clear();
+}
+
+/*
+ * Make "serve" return.
+ */
+void solverDaemon::stop(void) {
+   char c = 0;
+   if (write(wakeFd[1], &c, 1) < 0) {
+      // pipe full: "serve" has been woken already
+   }
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Destructor.
+ */
+solverDaemon::connection::~connection(void) {
+   close(fd);
+}
+
+/*
+ * Queue (or act on) each whole line received from 'c'.
+ */
+void solverDaemon::readRequests(const shared_ptr<connection> &c) {
+   size_t start = 0, end;
+   while ((end = c->input.find('\n', start)) != string::npos) {
+      string line = c->input.substr(start, end - start);
+      if (!line.empty() && line[line.size() - 1] == '\r')
+        line.erase(line.size() - 1);
+      if (line.find_first_not_of(" \t") != string::npos)
+        parseRequest(c, line);
+      start = end + 1;
+   }
+   c->input.erase(0, start);
+}
+
+/*
+ * Queue request 'line' from 'c', cancel the request it names, or reply
+ * with an error if it is invalid.
+ */
+void solverDaemon::parseRequest(const shared_ptr<connection> &c, const string &line) {
+   istringstream in(line);
+   string cmd, piece;
+   long id;
+   if (!(in >> id >> cmd)) {
+      reply(*c, "0 error expected ID COMMAND");
+      return;
+   }
+   ostringstream error;
+   error << id << " error ";
+
+   if (cmd == "cancel") {
+      cancelRequests(c.get(), id, false);
+      return;
+   }
+   shared_ptr<request> r = make_shared<request>();
+   r->id     = id;
+   r->cancel = false;
+   r->conn   = c;
+   if (cmd == "solve")
+     r->cmd = SOLVE_COMMAND;
+   else if (cmd == "count")
+     r->cmd = COUNT_COMMAND;
+   else if (cmd == "hint")
+     r->cmd = HINT_COMMAND;
+   else {
+      error << "unknown command \"" << cmd << "\"";
+      reply(*c, error.str());
+      return;
+   }
+
+   long ms;
+   if (!(in >> r->set >> ms) || ms < 0) {
+      error << "expected SET DEADLINE";
+      reply(*c, error.str());
+      return;
+   }
+   if (r->set.find('/') != string::npos || r->set.find("..") != string::npos) {
+      error << "set must name files in data directory";
+      reply(*c, error.str());
+      return;
+   }
+   r->deadline = ms > 0 ? chrono::steady_clock::now() + chrono::milliseconds(ms)
+                        : chrono::steady_clock::time_point::max();
+   while (in >> piece) {
+      piecePlacement p;
+      char dot1, dot2, extra;
+      if (sscanf(piece.c_str(), "%d%c%d%c%d%c", &p.block, &dot1, &p.orientation, &dot2,
+                 &p.anchor, &extra) != 5 || dot1 != '.' || dot2 != '.') {
+         error << "invalid piece \"" << piece << "\"";
+         reply(*c, error.str());
+         return;
+      }
+      r->pieces.push_back(p);
+   }
+
+   {
+      lock_guard<mutex> guard(lock);
+      queue.push_back(r);
+      running.push_back(r);
+   }
+   ready.notify_one();
+}
+
+/*
+ * Cancel request 'id' of connection 'c', or all of its requests if 'all'.
+ */
+void solverDaemon::cancelRequests(const connection *c, long id, bool all) {
+   lock_guard<mutex> guard(lock);
+   for (int i = 0; i < (int)running.size(); ++i)
+     if (running[i]->conn.get() == c && (all || running[i]->id == id))
+       running[i]->cancel = true;
+}
+
+/*
+ * Answer queued requests until "serve" ends (worker thread).
+ */
+void solverDaemon::workerMain(void) {
+   for (;;) {
+      shared_ptr<request> r;
+      {
+         unique_lock<mutex> guard(lock);
+         ready.wait(guard, [this] {return stopping || !queue.empty();});
+         if (stopping)
+           return;
+         r = queue.front();
+         queue.pop_front();
+      }
+      answer(*r);
+      lock_guard<mutex> guard(lock);
+      running.erase(find(running.begin(), running.end(), r));
+      ++requestCount;
+   }
+}
+
+/*
+ * Answer request 'r' on the calling worker thread.
+ */
+void solverDaemon::answer(request &r) {
+   ostringstream out;
+   out << r.id << " ";
+   if (r.cancel) {
+      reply(*r.conn, out.str() + "cancelled");
+      return;
+   }
+   if (chrono::steady_clock::now() >= r.deadline) {
+      reply(*r.conn, out.str() + "timeout 0"); // expired while queued
+      return;
+   }
+
+   string error;
+   loadedPuzzle *p = takePuzzle(r.set, error);
+   if (p == NULL) {
+      reply(*r.conn, out.str() + "error " + error);
+      return;
+   }
+   puzzle &puz = *p->puz;
+   if (!puz.addPieces(r.pieces)) {
+      givePuzzle(p);
+      reply(*r.conn, out.str() + "error pieces do not fit");
+      return;
+   }
+
+   vector<piecePlacement> found; // blocks of first solution
+   puz.setCountOnly(true);
+   puz.setSolutionLimit(r.cmd == COUNT_COMMAND ? 0 : 1);
+   puz.setDeadline(r.deadline);
+   puz.setCancelFlag(&r.cancel);
+   puz.setSolutionHandler([&found](const piecePlacement *pieces, int n) {
+      if (found.empty())
+        found.assign(pieces, pieces + n);
+   });
+   long n = puz.solve();
+   bool completed = puz.getCompleted();
+   puz.setCancelFlag(NULL);
+   puz.setSolutionHandler(nullptr);
+   puz.removePieces((int)r.pieces.size());
+   givePuzzle(p);
+
+   if (r.cancel)
+     out << "cancelled";
+   else if (r.cmd != COUNT_COMMAND && n > 0) {
+      out << "ok 1";
+      int shown = r.cmd == HINT_COMMAND ? 1 : (int)found.size();
+      for (int i = 0; i < shown && i < (int)found.size(); ++i)
+        out << " " << found[i].block << "." << found[i].orientation << "." << found[i].anchor;
+   }
+   else if (completed)
+     out << "ok " << n;
+   else
+     out << "timeout " << n;
+   reply(*r.conn, out.str());
+}
+
+/*
+ * Return an idle puzzle with request set 'set' loaded, loading it into
+ * a new puzzle (or the least recently used idle one if there are enough)
+ * if there is none.  Return NULL and set 'error' if it cannot be read.
+ */
+solverDaemon::loadedPuzzle *solverDaemon::takePuzzle(const string &set, string &error) {
+   loadedPuzzle *p = NULL;
+   {
+      lock_guard<mutex> guard(lock);
+      int oldest = -1;
+      for (int i = 0; i < (int)idle.size(); ++i) {
+         if (idle[i]->set == set) {
+            p = idle[i];
+            idle.erase(idle.begin() + i);
+            p->lastUsed = ++uses;
+            return p;
+         }
+         if (oldest == -1 || idle[i]->lastUsed < idle[oldest]->lastUsed)
+           oldest = i;
+      }
+      if ((int)puzzles.size() >= maxPuzzles && oldest != -1) {
+         p = idle[oldest];
+         idle.erase(idle.begin() + oldest);
+      }
+      else {
+         p = new loadedPuzzle;
+         p->puz = new puzzle;
+         puzzles.push_back(p);
+      }
+      p->set.clear();
+      p->lastUsed = ++uses;
+      ++loadCount;
+   }
+
+   // read files without holding lock
+   size_t colon = set.find(':');
+   string blockFile = dataDir + "/" + set.substr(0, colon),
+          boardFile = colon == string::npos ? "" : dataDir + "/" + set.substr(colon + 1);
+   if (boardFile.empty())
+     p->puz->setBoard(board());
+   else if (!p->puz->readBoard(boardFile.c_str()))
+     error = "cannot read board \"" + set.substr(colon + 1) + "\"";
+   if (error.empty() && !p->puz->readBlockSet(blockFile.c_str()))
+     error = p->puz->getReadError();
+   if (!error.empty()) {
+      givePuzzle(p);
+      return NULL;
+   }
+   p->set = set;
+   return p;
+}
+
+/*
+ * Return puzzle 'p' to the idle puzzles.
+ */
+void solverDaemon::givePuzzle(loadedPuzzle *p) {
+   lock_guard<mutex> guard(lock);
+   idle.push_back(p);
+}
+
+/*
+ * Send line 'text' to 'c'.  If the client has gone, cancel its other
+ * requests (no one is left to answer).
+ */
+void solverDaemon::reply(connection &c, const string &text) {
+   string line = text + "\n";
+   bool failed = false;
+   {
+      lock_guard<mutex> guard(c.writeLock);
+      for (size_t sent = 0; sent < line.size() && !failed;) {
+         ssize_t n = send(c.fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+         if (n < 0 && errno == EINTR)
+           continue;
+         if (n <= 0)
+           failed = true;
+         else
+           sent += n;
+      }
+   }
+   if (failed)
+     cancelRequests(&c, 0, true);
+}
@@ -0,0 +1,159 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "daemon.h" - Class "solverDaemon" definition.                                                   *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+#include "puzzle.h"
+
+#define DAEMON_MAX_LINE    65536 // longest request accepted (bytes)
+#define DAEMON_MAX_PUZZLES 16    // default number of loaded puzzles kept
+
+/*
+ * Long running solver answering requests from clients connected to a
+ * Unix domain socket.  Requests and replies are lines of text.  A
+ * request is
+ *
+ *    ID COMMAND SET DEADLINE [PIECE ...]
+ *
+ * where ID is a number chosen by the client (replies carry it, and may
+ * come in any order), COMMAND is "solve" (find one solution), "count"
+ * (count solutions) or "hint" (find one block leading to a solution),
+ * SET is a block set file in the data directory, optionally followed by
+ * ":" and a board file there (see "board.h"), DEADLINE is the number of
+ * milliseconds the request may take from its receipt (0 = no limit) and
+ * each PIECE is a block already in the puzzle as "block.orientation.anchor"
+ * (see "piecePlacement").  "ID cancel" cancels request ID of the same
+ * connection, queued or running.  A client may shut down its side of
+ * the connection after sending its requests: they are still answered,
+ * and the connection closed after the last.  Requests are cancelled if
+ * the client closes the connection or a reply cannot be sent.  Replies are
+ *
+ *    ID ok N [PIECE ...]  solve: N is 1 and the pieces are the blocks
+ *                         completing the puzzle, or 0 if it cannot be
+ *                         solved; hint: the same with only the first of
+ *                         those blocks; count: N is the number of solutions
+ *    ID timeout N         deadline passed after N solutions were found
+ *    ID cancelled
+ *    ID error MESSAGE
+ *
+ * Requests are queued and answered by a fixed set of worker threads.
+ * Each loaded puzzle keeps its block set, board and placement table, so
+ * only the first request for a set (and one per worker answering such
+ * requests at once) reads files; the least recently used idle puzzle is
+ * dropped when more than the maximum are loaded.  A deadline or cancel
+ * stops a running search within SEARCH_POLL_INTERVAL nodes (see
+ * "puzzle::setDeadline").
+ */
+class solverDaemon {
+ public:
+   solverDaemon(const char *dataDir);
+   ~solverDaemon(void);
+
+   /*
+    * Set number of requests answered at once (default number of
+    * processors) and number of loaded puzzles kept (at least as many).
+    */
+   void setWorkers(int n)    {workers = n > 0 ? n : 1;   }
+   void setMaxPuzzles(int n) {maxPuzzles = n > 0 ? n : 1;}
+
+   /*
+    * Listen for connections on socket 'path' (replacing any socket
+    * there).  Return false and set 'error' on failure.
+    */
+   bool listen(const char *path, std::string &error);
+
+   /*
+    * Answer requests until "stop" is called.
+    */
+   void serve(void);
+
+   /*
+    * Make "serve" return, cancelling requests running.  May be called
+    * from any thread or from a signal handler.
+    */
+   void stop(void);
+
+   /*
+    * Return number of requests answered, and number of times a block
+    * set was read.
+    */
+   long getRequestCount(void) {return requestCount;}
+   long getLoadCount(void)    {return loadCount;   }
+
+ private:
+   enum command {SOLVE_COMMAND, COUNT_COMMAND, HINT_COMMAND};
+
+   // client connection, closed when the last request holding it is answered
+   struct connection {
+      connection(int f) : fd(f) {}
+      ~connection(void);
+      int fd;
+      std::string input;    // received but not yet a whole line
+      std::mutex  writeLock;
+   };
+
+   struct request {
+      long id;
+      command cmd;
+      std::string set;
+      std::vector<piecePlacement> pieces;
+      std::chrono::steady_clock::time_point deadline;
+      std::atomic<bool> cancel;
+      std::shared_ptr<connection> conn;
+   };
+
+   // puzzle with the block set and board of request set 'set' loaded
+   struct loadedPuzzle {
+      puzzle     *puz;
+      std::string set;
+      long        lastUsed; // order last taken
+   };
+
+   solverDaemon(const solverDaemon &);            // not copyable
+   solverDaemon &operator=(const solverDaemon &);
+
+   void readRequests(const std::shared_ptr<connection> &c);
+   void parseRequest(const std::shared_ptr<connection> &c, const std::string &line);
+   void cancelRequests(const connection *c, long id, bool all);
+   void workerMain(void);
+   void answer(request &r);
+   loadedPuzzle *takePuzzle(const std::string &set, std::string &error);
+   void givePuzzle(loadedPuzzle *p);
+   void reply(connection &c, const std::string &text);
+
+   std::string dataDir,
+               socketPath;
+   int listenFd,
+       wakeFd[2]; // pipe written by "stop" to wake "serve"
+   int workers,
+       maxPuzzles;
+   std::vector<std::thread> threads;
+   std::mutex lock; // guards members below
+   std::condition_variable ready;
+   std::deque<std::shared_ptr<request> > queue;
+   std::vector<std::shared_ptr<request> > running; // queued or being answered
+   std::vector<loadedPuzzle *> puzzles, // all loaded
+                               idle;    // not in use
+   bool stopping;
+   long uses,
+        requestCount,
+        loadCount;
+};
+
+#endif
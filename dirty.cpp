@@ -0,0 +1,84 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "dirty.cpp" - Member functions of class "dirtyGrid" (defined in "dirty.h").                     *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <algorithm>
+
+#include "dirty.h"
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Make grid 'h' x 'w' squares, none shown.
+ */
+void dirtyGrid::resize(int h, int w) {
+   height = h;
+   width  = w;
+   drawn.assign(h * w, RGB(0, 0, 0));
+   shown.assign(h * w, NOT_SHOWN);
+   isTouched.assign(h * w, false);
+   touched.clear();
+}
+
+/*
+ * Record square (r, c) as drawn in 'colour'.
+ */
+void dirtyGrid::set(int r, int c, COLORREF colour) {
+   int i = r * width + c;
+   drawn[i] = colour;
+   if (!isTouched[i]) {
+      isTouched[i] = true;
+      touched.push_back(i);
+   }
+}
+
+/*
+ * Gather squares changed since last shown into rectangles.
+ */
+void dirtyGrid::flush(std::vector<dirtyRect> &rects) {
+   rects.clear();
+   if (touched.empty())
+     return;
+
+   // squares whose colour differs from that shown, in row order
+   int n = 0;
+   for (int k = 0; k < (int)touched.size(); ++k) {
+      int i = touched[k];
+      isTouched[i] = false;
+      if (drawn[i] != shown[i]) {
+         shown[i]   = drawn[i];
+         touched[n++] = i;
+      }
+   }
+   touched.resize(n);
+   std::sort(touched.begin(), touched.end());
+
+   // runs along each row, extending rectangle of same columns ending on row above
+   size_t open = 0; // rectangles from 'open' on end on row above (or this row)
+   for (int k = 0; k < n;) {
+      int r = touched[k] / width,
+          c = touched[k] % width,
+          w = 1;
+      while (k + w < n && touched[k + w] == touched[k] + w && (c + w) < width)
+        ++w;
+      k += w;
+
+      while (open < rects.size() && rects[open].r + rects[open].h < r)
+        ++open; // ended before row above
+      size_t j;
+      for (j = open; j < rects.size(); ++j)
+        if (rects[j].r + rects[j].h == r && rects[j].c == c && rects[j].w == w)
+          break;
+      if (j < rects.size())
+        ++rects[j].h;
+      else {
+         dirtyRect d = {r, c, 1, w};
+         rects.push_back(d);
+      }
+   }
+   touched.clear();
+}
@@ -0,0 +1,81 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "dirty.h" - Class "dirtyGrid" definition.                                                       *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef DIRTY_H
+#define DIRTY_H
+
+#include <vector>
+
+#include "colour.h"
+
+#define NOT_SHOWN ((COLORREF)-1) // colour of squares not yet shown (no real colour)
+
+/*
+ * Rectangle of grid squares: 'h' rows from row 'r', 'w' columns from column 'c'.
+ */
+struct dirtyRect {
+   int r, c, h, w;
+};
+
+/*
+ * Tracks the colour of each square of a grid as shown on screen and as
+ * last drawn, so that only squares whose colour has changed since they
+ * were last shown need be drawn again: a block moved one square, or
+ * rotated in place, changes only the squares in one of its old and new
+ * footprints but not both.  The changed squares are gathered into
+ * rectangles to be drawn and shown together.
+ */
+class dirtyGrid {
+ public:
+   dirtyGrid(void) {height = width = 0;}
+
+   /*
+    * Make grid 'h' x 'w' squares, none shown yet (so the next colour
+    * drawn in each is shown, whatever it is).
+    */
+   void resize(int h, int w);
+
+   /*
+    * Forget what is shown (as "resize" does).
+    */
+   void invalidate(void) {shown.assign(shown.size(), NOT_SHOWN);}
+
+   /*
+    * Record square (r, c) as drawn in 'colour'.
+    */
+   void set(int r, int c, COLORREF colour);
+
+   /*
+    * Return colour square (r, c) was last drawn in.
+    */
+   COLORREF get(int r, int c) const {return drawn[r * width + c];}
+
+   /*
+    * Set 'rects' to rectangles covering exactly the squares drawn in a
+    * colour other than that shown, and record them as shown.  Runs of
+    * changed squares along each row are joined with runs of the same
+    * columns in the rows below, giving one rectangle per row of a
+    * block's footprint at most, and often fewer.
+    */
+   void flush(std::vector<dirtyRect> &rects);
+
+   /*
+    * Return whether any square has been drawn but not shown.
+    */
+   bool isDirty(void) const {return !touched.empty();}
+
+ private:
+   int height,
+       width;
+   std::vector<COLORREF> drawn, // colour of each square last drawn
+                         shown; // colour of each square last shown
+   std::vector<int>  touched;   // squares drawn since last "flush"
+   std::vector<bool> isTouched; // square in 'touched'
+};
+
+#endif
@@ -0,0 +1,196 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "dlx.cpp" - Member functions of class "dlx" (defined in "dlx.h").                               *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include "dlx.h"
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Find all exact covers.  Return true if the search ran to
+ * completion, false if halted by the observer.
+ */
+bool dlx::run(void) {
+   nodes         = 0;
+   tested        = 0;
+   solutionCount = 0;
+   percentSolved = 0;
+   chosen.clear();
+   if (R[0] == 0)
+     return true; // nothing to solve (no solution, as "backtrackSearch::run")
+   return solveRecursively();
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Empty the matrix, leaving only the root node.
+ */
+void dlx::init(void) {
+   L.assign(1, 0);
+   R.assign(1, 0);
+   U.assign(1, 0);
+   D.assign(1, 0);
+   C.assign(1, 0);
+   rowOf.assign(1, -1);
+   columnSize.assign(1, 0);
+   rows.clear();
+}
+
+/*
+ * Add a column header.  Primary columns are linked into the list of
+ * columns that must be covered, secondary columns are left out of it.
+ * Return the header node of the new column.
+ * (all columns must be added before any rows)
+ */
+int dlx::addColumn(const bool primary) {
+   int c = (int)L.size();
+   if (primary) {
+      L.push_back(L[0]);
+      R.push_back(0);
+      R[L[0]] = c;
+      L[0] = c;
+   }
+   else {
+      L.push_back(c);
+      R.push_back(c);
+   }
+   U.push_back(c);
+   D.push_back(c);
+   C.push_back(c);
+   rowOf.push_back(-1);
+   columnSize.push_back(0);
+   return c;
+}
+
+/*
+ * Add a row with a node in each of 'columns' for placement 'p'.
+ */
+void dlx::addRow(const piecePlacement &p, const std::vector<int> &columns) {
+   int row   = (int)rows.size(),
+       first = (int)L.size(),
+       i;
+   rows.push_back(p);
+   for (i = 0; i < (int)columns.size(); ++i) {
+      int n = (int)L.size(),
+          c = columns[i];
+      // link vertically at bottom of column
+      U.push_back(U[c]);
+      D.push_back(c);
+      D[U[c]] = n;
+      U[c] = n;
+      C.push_back(c);
+      rowOf.push_back(row);
+      ++columnSize[c];
+      // link horizontally in circular list of row
+      L.push_back(i == 0 ? n : n - 1);
+      R.push_back(first);
+      if (i > 0) {
+         R[n - 1] = n;
+         L[first] = n;
+      }
+   }
+}
+
+/*
+ * Remove column 'c' from header list and remove all rows in
+ * column 'c' from the other columns they are in.
+ */
+void dlx::cover(const int c) {
+   R[L[c]] = R[c];
+   L[R[c]] = L[c];
+   for (int i = D[c]; i != c; i = D[i])
+     for (int j = R[i]; j != i; j = R[j]) {
+        U[D[j]] = U[j];
+        D[U[j]] = D[j];
+        --columnSize[C[j]];
+     }
+}
+
+/*
+ * Undo "cover(c)".
+ */
+void dlx::uncover(const int c) {
+   for (int i = U[c]; i != c; i = U[i])
+     for (int j = L[i]; j != i; j = L[j]) {
+        ++columnSize[C[j]];
+        U[D[j]] = j;
+        D[U[j]] = j;
+     }
+   R[L[c]] = c;
+   L[R[c]] = c;
+}
+
+/*
+ * Algorithm X.  Return false if solution process has been halted.
+ */
+bool dlx::solveRecursively(void) {
+   if (++nodes % SEARCH_POLL_INTERVAL == 0 && !observer.poll(percentSolved, nodes))
+     return false;
+
+   if (R[0] == 0) {
+      // all squares covered
+      return reportSolution();
+   }
+
+   // choose column with fewest rows
+   int c = R[0], i, j;
+   for (j = R[c]; j != 0; j = R[j])
+     if (columnSize[j] < columnSize[c])
+       c = j;
+   if (columnSize[c] == 0)
+     return true; // dead end
+
+   int candidates = columnSize[c];
+   tested += candidates;
+   cover(c);
+   for (i = D[c]; i != c; i = D[i]) {
+      // update progress each time the puzzle is cleared
+      if (chosen.empty()) {
+         if (!observer.poll(percentSolved, nodes)) {
+            uncover(c);
+            return false;
+         }
+         percentSolved += 100 / (double)candidates;
+      }
+
+      chosen.push_back(rowOf[i]);
+      for (j = R[i]; j != i; j = R[j])
+        cover(C[j]);
+
+      bool finished = solveRecursively();
+
+      for (j = L[i]; j != i; j = L[j])
+        uncover(C[j]);
+      chosen.pop_back();
+
+      if (!finished) {
+         // solution process has been halted early
+         uncover(c);
+         return false;
+      }
+   }
+   uncover(c);
+   return true;
+}
+
+static bool anchorLess(const piecePlacement &a, const piecePlacement &b) {
+   return a.anchor < b.anchor;
+}
+
+/*
+ * Pass solution on stack to observer, blocks sorted by anchor square.
+ * Return false if the observer halts the search.
+ */
+bool dlx::reportSolution(void) {
+   pieces.clear();
+   for (int i = 0; i < (int)chosen.size(); ++i)
+     pieces.push_back(rows[chosen[i]]);
+   std::sort(pieces.begin(), pieces.end(), anchorLess);
+   ++solutionCount;
+   return observer.solution(&pieces[0], (int)pieces.size());
+}
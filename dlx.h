@@ -0,0 +1,126 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "dlx.h" - Class "dlx" definition.                                                               *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef DLX_H
+#define DLX_H
+
+#include <vector>
+#include <algorithm>
+
+#include "search.h"
+
+/*
+ * Exact cover search using Knuth's Dancing Links (Algorithm X).
+ * The puzzle is modelled as a matrix with one primary column for each
+ * empty square of the grid (must be covered exactly once) and one
+ * column for each unused block.  Each placement of a block that fits in
+ * the empty squares is a row.  At each step the primary column with the
+ * fewest remaining rows is covered next.
+ *
+ * If the unused blocks have as many squares as there are empty squares
+ * (true of every shipped block set and board) each must be used, so
+ * block columns are primary too and a block with few placements left
+ * may be chosen before any square.  Otherwise (more blocks than are
+ * needed) they are secondary: each block may be used at most once.
+ *
+ * Solutions are reported to the observer with blocks in order of
+ * anchor square, the same order "backtrackSearch" places them in, so both
+ * searches write identical solution file lines.  The solutions are found
+ * in a different order though (the column covered first is not the first
+ * empty square), so the lines are not in the same order: solution 'n' of
+ * a file written by one engine need not be solution 'n' of the other's.
+ * A grid with no empty squares has no solutions, as with backtracking.
+ */
+class dlx {
+ public:
+   dlx(searchObserver &o) : observer(o) {}
+
+   /*
+    * Build the exact cover matrix for placements in 't' given the
+    * squares already 'occupied' and 'usedBlocks' (bit 'i' set if
+    * block 'i' is already in the puzzle).
+    */
+   template <int WORDS>
+   void build(const placementTable<WORDS> &t, const bitboard<WORDS> &occupied,
+              const blockMask usedBlocks) {
+      int cells   = t.getCells(),
+          nBlocks = t.getBlockCount(),
+          empty   = 0,
+          area    = 0,
+          i, j;
+      std::vector<int> cellColumn(cells, -1), blockColumn;
+      std::vector<int> rowColumns;
+      bitboard<WORDS> mask;
+
+      // one primary column per empty square
+      init();
+      for (i = 0; i < cells; ++i)
+        if (!occupied.test(i)) {
+           cellColumn[i] = addColumn(true);
+           ++empty;
+        }
+
+      // one column per unused block, primary if every one must be used
+      for (i = 0; i < nBlocks; ++i)
+        if (!((usedBlocks >> i) & 1))
+          area += t.getBlockSize(i);
+      blockColumn.assign(nBlocks, -1);
+      for (i = 0; i < nBlocks; ++i)
+        if (!((usedBlocks >> i) & 1))
+          blockColumn[i] = addColumn(area == empty);
+
+      // one row per placement that does not overlap occupied squares
+      for (i = 0; i < t.getCount(); ++i) {
+         const placement<WORDS> &p = t[i];
+         if (blockColumn[p.piece.block] == -1 || !t.fits(p, occupied))
+           continue;
+         rowColumns.clear();
+         for (t.getMask(p, mask); !mask.empty(); mask.reset(j)) {
+            j = mask.firstSet();
+            rowColumns.push_back(cellColumn[j]);
+         }
+         rowColumns.push_back(blockColumn[p.piece.block]);
+         addRow(p.piece, rowColumns);
+      }
+   }
+
+   /*
+    * Find all exact covers.  Return true if the search ran to
+    * completion, false if halted by the observer.
+    */
+   bool run(void);
+
+   long   getSolutionCount(void) const {return solutionCount;}
+   long   getNodeCount(void) const     {return nodes;        }
+   long   getTestedCount(void) const   {return tested;       }
+   double getPercentSolved(void) const {return percentSolved;}
+
+ private:
+   void init(void);
+   int  addColumn(bool primary);
+   void addRow(const piecePlacement &, const std::vector<int> &columns);
+   void cover(int c);
+   void uncover(int c);
+   bool solveRecursively(void);
+   bool reportSolution(void);
+
+   // node links; nodes 0 .. number of columns are column headers, node 0 is the root
+   std::vector<int> L, R, U, D, C,
+                    rowOf;      // row of each non-header node
+   std::vector<int> columnSize; // number of rows in each column (index = header node)
+   std::vector<piecePlacement> rows;
+   std::vector<int> chosen;     // row of each node on solution stack
+   std::vector<piecePlacement> pieces;
+   searchObserver &observer;
+   long nodes,
+        tested, // rows tried (every row left in a column fits)
+        solutionCount;
+   double percentSolved;
+};
+
+#endif
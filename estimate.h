@@ -0,0 +1,117 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "estimate.h" - Class template "treeEstimator" definition.                                       *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include <vector>
+#include <chrono>
+
+#include "placement.h"
+
+#define ESTIMATE_PROBES          1000 // random paths sampled before a search starts
+#define ESTIMATE_PROBES_PER_POLL 1    // further paths sampled each time the search is polled
+
+/*
+ * Estimates the size of the tree "backtrackSearch" would search from
+ * a given state by Knuth's method: follow random paths from the root,
+ * at each node choosing one of the blocks that fit the first empty
+ * square at random.  A node reached after choosing among d1, d2, ...
+ * dk children stands for d1 * d2 * ... * dk nodes at its depth, and
+ * the sum of these products over a path is an unbiased estimate of the
+ * number of nodes in the tree (and likewise of solutions).  Estimates
+ * of many paths are averaged.
+ *
+ * Dead region pruning is not modelled, so with it on the search visits
+ * fewer nodes than estimated.
+ */
+template <int WORDS>
+class treeEstimator {
+ public:
+   treeEstimator(const placementTable<WORDS> &t, const bitboard<WORDS> &occupied,
+                 const blockMask usedBlocks)
+     : table(t), start(occupied), startUsed(usedBlocks) {
+      probes      = 0;
+      nodeSum     = 0;
+      solutionSum = 0;
+      visited     = 0;
+      seconds     = 0;
+      state       = 0x9e3779b97f4a7c15ULL; // fixed seed: same estimate every time
+   }
+
+   /*
+    * Follow 'n' more random paths.  Return estimated number of nodes.
+    */
+   double probe(const int n) {
+      std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+      for (int i = 0; i < n; ++i)
+        probeOnce();
+      seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+      return getNodes();
+   }
+
+   double getNodes(void) const      {return probes > 0 ? nodeSum / probes : 0;    }
+   double getSolutions(void) const  {return probes > 0 ? solutionSum / probes : 0;}
+   long   getProbeCount(void) const {return probes;                              }
+
+   /*
+    * Return rate at which paths visited nodes.  Each node of a path
+    * costs what a search node costs (testing every placement anchored
+    * on the first empty square), so this approximates search speed.
+    */
+   double getNodesPerSecond(void) const {return seconds > 0 ? visited / seconds : 0;}
+
+ private:
+   void probeOnce(void) {
+      bitboard<WORDS> occ = start;
+      blockMask used = startUsed;
+      double weight = 1; // nodes at this depth each node on path stands for
+      int cells = table.getCells(),
+          cell  = occ.firstClear(0, cells),
+          i;
+      while (cell < cells) {
+         nodeSum += weight;
+         ++visited;
+         fitting.clear();
+         for (i = table.first(cell); i < table.last(cell); ++i)
+           if (!((used >> table[i].piece.block) & 1) && table.fits(table[i], occ))
+             fitting.push_back(i);
+         if (fitting.empty())
+           break; // dead end
+         weight *= fitting.size();
+         const placement<WORDS> &p = table[fitting[random((int)fitting.size())]];
+         table.toggle(p, occ);
+         used |= (blockMask)1 << p.piece.block;
+         cell  = occ.firstClear(cell + 1, cells);
+         if (cell == cells)
+           solutionSum += weight;
+      }
+      ++probes;
+   }
+
+   // xorshift random number in 0 .. n-1
+   int random(const int n) {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return (int)((state * 0x2545f4914f6cdd1dULL >> 33) % n);
+   }
+
+   const placementTable<WORDS> &table;
+   bitboard<WORDS> start;
+   blockMask startUsed;
+   std::vector<int> fitting; // placements fitting node on current path
+   long probes;
+   double nodeSum,     // sum over paths of estimated nodes
+          solutionSum, // sum over paths of estimated solutions
+          visited,     // nodes visited by all paths
+          seconds;     // time spent following paths
+   unsigned long long state;
+};
+
+#endif
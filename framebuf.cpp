@@ -0,0 +1,102 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "framebuf.cpp" - Member functions of class "frameBuffer" (defined in "framebuf.h").             *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "framebuf.h"
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Make image 'w' x 'h' pixels, all black.
+ */
+void frameBuffer::resize(int w, int h) {
+   width  = w > 0 ? w : 0;
+   height = h > 0 ? h : 0;
+   pixels.assign((size_t)width * height * 3, 0);
+   text.clear();
+   presents = presented = 0;
+}
+
+/*
+ * Fill rectangle of image with 'colour'.
+ */
+void frameBuffer::fillRect(int x, int y, int w, int h, COLORREF colour) {
+   if (!clip(x, y, w, h))
+     return;
+   unsigned char rgb[3] = {(unsigned char)(colour & 0xff),
+                           (unsigned char)((colour >> 8) & 0xff),
+                           (unsigned char)((colour >> 16) & 0xff)};
+
+   // fill first row, then copy it to the others
+   unsigned char *first = &pixels[((size_t)y * width + x) * 3];
+   for (int i = 0; i < w; ++i)
+     memcpy(first + i * 3, rgb, 3);
+   for (int r = 1; r < h; ++r)
+     memcpy(first + (size_t)r * width * 3, first, (size_t)w * 3);
+}
+
+/*
+ * Keep 't' as the text drawn.
+ */
+void frameBuffer::drawText(int, int, const char *t, COLORREF) {
+   text = t;
+}
+
+/*
+ * Count pixels that would be shown.
+ */
+void frameBuffer::present(int x, int y, int w, int h) {
+   ++presents;
+   if (clip(x, y, w, h))
+     presented += (long)w * h;
+}
+
+/*
+ * Return colour of pixel ('x', 'y').
+ */
+COLORREF frameBuffer::getPixel(int x, int y) const {
+   if (x < 0 || y < 0 || x >= width || y >= height)
+     return RGB(0, 0, 0);
+   const unsigned char *p = &pixels[((size_t)y * width + x) * 3];
+   return RGB(p[0], p[1], p[2]);
+}
+
+/*
+ * Write image as binary PPM.
+ */
+bool frameBuffer::writePPM(const char *fileName) const {
+   FILE *file = fopen(fileName, "wb");
+   if (file == NULL)
+     return false;
+   fprintf(file, "P6\n%d %d\n255\n", width, height);
+   bool ok = pixels.empty() || fwrite(&pixels[0], 1, pixels.size(), file) == pixels.size();
+   return fclose(file) == 0 && ok;
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Clip rectangle to image.
+ */
+bool frameBuffer::clip(int &x, int &y, int &w, int &h) const {
+   if (x < 0) {
+      w += x;
+      x = 0;
+   }
+   if (y < 0) {
+      h += y;
+      y = 0;
+   }
+   if (x + w > width)
+     w = width - x;
+   if (y + h > height)
+     h = height - y;
+   return w > 0 && h > 0;
+}
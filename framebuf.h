@@ -0,0 +1,71 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "framebuf.h" - Class "frameBuffer" definition.                                                  *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef FRAMEBUF_H
+#define FRAMEBUF_H
+
+#include <string>
+#include <vector>
+
+#include "renderer.h"
+
+/*
+ * Renderer drawing into an RGB image in memory (3 bytes per pixel, rows
+ * top to bottom), for drawing the puzzle without a screen: tests,
+ * benchmarks and saving images.  Text is not rasterised; the last text
+ * drawn is kept instead.  "present" only counts the pixels it would
+ * have shown.
+ */
+class frameBuffer : public renderer {
+ public:
+   frameBuffer(void) {width = height = 0; presents = presented = 0;}
+
+   void resize(int w, int h);
+   void fillRect(int x, int y, int w, int h, COLORREF colour);
+   void drawText(int x, int y, const char *t, COLORREF colour);
+   void present(int x, int y, int w, int h);
+
+   int getWidth(void)  const {return width; }
+   int getHeight(void) const {return height;}
+
+   /*
+    * Return colour of pixel ('x', 'y').
+    */
+   COLORREF getPixel(int x, int y) const;
+
+   /*
+    * Return last text drawn.
+    */
+   const std::string &getText(void) const {return text;}
+
+   /*
+    * Return number of "present" calls and pixels shown by them since
+    * "resize" (or "resetCounts").
+    */
+   long getPresentCount(void) const   {return presents; }
+   long getPresentedPixels(void) const {return presented;}
+   void resetCounts(void)              {presents = presented = 0;}
+
+   /*
+    * Write the image to 'fileName' as a binary PPM.  Return false on failure.
+    */
+   bool writePPM(const char *fileName) const;
+
+ private:
+   // clip rectangle to image, return false if nothing left
+   bool clip(int &x, int &y, int &w, int &h) const;
+
+   int width,
+       height;
+   std::vector<unsigned char> pixels;
+   std::string text;
+   long presents,
+        presented;
+};
+
+#endif
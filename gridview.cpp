@@ -0,0 +1,85 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "gridview.cpp" - Member functions of class "gridView" (defined in "gridview.h").                *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include "gridview.h"
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Set size of puzzle grid, resizing back buffer to fit.
+ */
+void gridView::setGridSize(int h, int w) {
+   height = h;
+   width  = w;
+   squares.resize(h, w);
+   if (out != NULL) {
+      out->resize(getPixelWidth(), getPixelHeight());
+      out->fillRect(0, height * SQUARE_SIZE, getPixelWidth(), TEXT_AREA_HEIGHT, TEXT_AREA_COLOUR);
+   }
+}
+
+/*
+ * Draw square (r, c) of puzzle grid in 'colour'.
+ */
+void gridView::drawSquare(COLORREF colour, int r, int c) {
+   squares.set(r, c, colour);
+   if (batching == 0)
+     flush();
+}
+
+/*
+ * Draw text in text area below puzzle grid.
+ */
+void gridView::drawText(const char *text) {
+   if (out == NULL)
+     return;
+   int top = height * SQUARE_SIZE;
+   out->fillRect(0, top, getPixelWidth(), TEXT_AREA_HEIGHT, TEXT_AREA_COLOUR);
+   out->drawText(0, top, text, RGB(0, 0, 0));
+   textDrawn = true;
+   if (batching == 0)
+     flush();
+}
+
+/*
+ * Start drawing squares to be shown together.
+ */
+void gridView::beginDraw(void) {
+   ++batching;
+}
+
+/*
+ * Show everything drawn since matching "beginDraw".
+ */
+void gridView::endDraw(void) {
+   if (--batching == 0)
+     flush();
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Draw squares changed since last shown to back buffer, and show them
+ * and text area (if drawn).
+ */
+void gridView::flush(void) {
+   squares.flush(rects);
+   if (out == NULL)
+     return;
+   for (size_t i = 0; i < rects.size(); ++i) {
+      const dirtyRect &d = rects[i];
+      for (int r = d.r; r < d.r + d.h; ++r)
+        for (int c = d.c; c < d.c + d.w; ++c)
+          out->fillRect(c * SQUARE_SIZE, r * SQUARE_SIZE, SQUARE_SIZE, SQUARE_SIZE, squares.get(r, c));
+      out->present(d.c * SQUARE_SIZE, d.r * SQUARE_SIZE, d.w * SQUARE_SIZE, d.h * SQUARE_SIZE);
+   }
+   if (textDrawn) {
+      out->present(0, height * SQUARE_SIZE, getPixelWidth(), TEXT_AREA_HEIGHT);
+      textDrawn = false;
+   }
+}
@@ -0,0 +1,68 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "gridview.h" - Class "gridView" definition.                                                     *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef GRIDVIEW_H
+#define GRIDVIEW_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "view.h"
+#include "dirty.h"
+#include "renderer.h"
+
+#define SQUARE_SIZE      25 // pixels per side of each square of puzzle grid
+#define TEXT_AREA_HEIGHT 16 // pixels high of text area beneath grid
+#define TEXT_AREA_COLOUR RGB(200, 200, 200)
+
+/*
+ * Draws the puzzle with a "renderer": the grid at the top left and a
+ * text area TEXT_AREA_HEIGHT pixels high beneath it.  Squares drawn
+ * between "beginDraw" and "endDraw" (eg. the whole grid by
+ * "puzzle::draw", or a held block erased and drawn again where it
+ * has moved) are shown at once at the end; others are shown
+ * as they are drawn.  Only squares whose colour differs from that shown
+ * are drawn to the back buffer and presented, a rectangle at a time
+ * (see "dirtyGrid").  Messages are ignored and "idle" always returns
+ * true unless a derived view says otherwise.
+ */
+class gridView : public puzzleView {
+ public:
+   gridView(renderer *r = NULL) {out = r; height = width = 0; batching = 0; textDrawn = false;}
+
+   void setRenderer(renderer *r) {out = r;}
+
+   void setGridSize(int h, int w);
+   void drawSquare(COLORREF colour, int r, int c);
+   void drawText(const char *text);
+   void showMessage(const char *) {}
+   bool idle(void)                {return true;}
+   void beginDraw(void);
+   void endDraw(void);
+
+   void invalidate(void) {squares.invalidate();}
+
+   /*
+    * Return size of area drawn in pixels.
+    */
+   int getPixelWidth(void)  {return width * SQUARE_SIZE;                   }
+   int getPixelHeight(void) {return height * SQUARE_SIZE + TEXT_AREA_HEIGHT;}
+
+ protected:
+   void flush(void);
+
+   renderer *out;
+   int height,
+       width,
+       batching;  // depth of "beginDraw" calls not yet ended
+   bool textDrawn; // text area drawn but not shown
+   dirtyGrid squares;
+   std::vector<dirtyRect> rects; // work space of "flush"
+};
+
+#endif
@@ -0,0 +1,130 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "mapfile.cpp" - Member functions of class "mappedFile" (defined in "mapfile.h").                *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "mapfile.h"
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Constructor.
+ */
+mappedFile::mappedFile(void) {
+   data     = 0;
+   size     = 0;
+   modified = 0;
+   opened   = false;
+#ifdef _WIN32
+   fileHandle = INVALID_HANDLE_VALUE;
+   mapHandle  = NULL;
+#endif
+}
+
+#ifdef _WIN32
+
+/*
+ * Map file 'fileName'.  Return false if it cannot be opened.
+ */
+bool mappedFile::open(const char *fileName) {
+   close();
+   fileHandle = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                            OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+   if (fileHandle == INVALID_HANDLE_VALUE)
+     return false;
+   LARGE_INTEGER fileSize;
+   FILETIME      writeTime;
+   GetFileSizeEx(fileHandle, &fileSize);
+   GetFileTime(fileHandle, NULL, NULL, &writeTime);
+   size     = (unsigned long long)fileSize.QuadPart;
+   modified = (unsigned long long)writeTime.dwHighDateTime << 32 | writeTime.dwLowDateTime;
+   if (size > 0) {
+      mapHandle = CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (mapHandle != NULL)
+        data = (const unsigned char *)MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+      if (data == NULL) {
+         close();
+         return false;
+      }
+   }
+   opened = true;
+   return true;
+}
+
+/*
+ * Unmap file.
+ */
+void mappedFile::close(void) {
+   if (data != NULL)
+     UnmapViewOfFile(data);
+   if (mapHandle != NULL)
+     CloseHandle(mapHandle);
+   if (fileHandle != INVALID_HANDLE_VALUE)
+     CloseHandle(fileHandle);
+   fileHandle = INVALID_HANDLE_VALUE;
+   mapHandle  = NULL;
+   data   = NULL;
+   size   = 0;
+   opened = false;
+}
+
+#else
+
+/*
+ * Map file 'fileName'.  Return false if it cannot be opened.
+ */
+bool mappedFile::open(const char *fileName) {
+   close();
+   int fd = ::open(fileName, O_RDONLY);
+   if (fd < 0)
+     return false;
+   struct stat st;
+   if (fstat(fd, &st) != 0) {
+      ::close(fd);
+      return false;
+   }
+   size     = (unsigned long long)st.st_size;
+#if defined(__APPLE__)
+   modified = (unsigned long long)st.st_mtimespec.tv_sec * 1000000000ULL + st.st_mtimespec.tv_nsec;
+#else
+   modified = (unsigned long long)st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec;
+#endif
+   if (size > 0) {
+      void *p = mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, fd, 0);
+      if (p == MAP_FAILED) {
+         ::close(fd);
+         size = 0;
+         return false;
+      }
+      madvise(p, (size_t)size, MADV_RANDOM); // solutions are read in any order
+      data = (const unsigned char *)p;
+   }
+   ::close(fd); // mapping stays valid
+   opened = true;
+   return true;
+}
+
+/*
+ * Unmap file.
+ */
+void mappedFile::close(void) {
+   if (data != 0)
+     munmap((void *)data, (size_t)size);
+   data   = 0;
+   size   = 0;
+   opened = false;
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "mapfile.h" - Class "mappedFile" definition.                                                    *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+/*
+ * Read only view of a whole file mapped into memory.  Pages are read
+ * by the OS as they are touched and shared between processes mapping
+ * the same file, so files larger than physical memory can be used.
+ */
+class mappedFile {
+ public:
+   mappedFile(void);
+   ~mappedFile(void) {close();}
+
+   /*
+    * Map file 'fileName'.  Return false if it cannot be opened.
+    */
+   bool open(const char *fileName);
+   void close(void);
+   bool isOpen(void) const {return opened;}
+
+   const unsigned char *getData(void) const {return data;}
+   unsigned long long   getSize(void) const {return size;}
+
+   /*
+    * Return time file was last modified (nanoseconds on POSIX systems,
+    * 100 nanosecond units on Windows).
+    */
+   unsigned long long getModified(void) const {return modified;}
+
+ private:
+   mappedFile(const mappedFile &);            // not copyable
+   mappedFile &operator=(const mappedFile &);
+
+   const unsigned char *data;
+   unsigned long long size,
+                      modified;
+   bool opened;
+#ifdef _WIN32
+   void *fileHandle,
+        *mapHandle;
+#endif
+};
+
+#endif
@@ -1,8 +1,17 @@
 //#define MENU_FILE_LOAD_NEW_BLOCK_SET   1000
-//#define MENU_FILE_LOAD_NEW_PUZZLE_GRID 1001
+#define MENU_FILE_LOAD_NEW_PUZZLE_GRID 1001
 #define MENU_FILE_EXIT                 1002
+#define MENU_FILE_REPLAY_SEARCH        1003
 
 #define MENU_OPTIONS_SOLVE             2000
+#define MENU_OPTIONS_EXACT_COVER       2001
+#define MENU_OPTIONS_PARALLEL          2002
+#define MENU_OPTIONS_BREAK_SYMMETRY    2003
+#define MENU_OPTIONS_EXPAND_SYMMETRY   2004
+#define MENU_OPTIONS_PRUNE             2005
+#define MENU_OPTIONS_COUNT_ONLY        2006
+#define MENU_OPTIONS_FIRST_ONLY        2007
+#define MENU_OPTIONS_WATCH             2008
 
 #define MENU_HELP_INSTRUCTIONS         3000
 #define MENU_HELP_ABOUT                3001
@@ -0,0 +1,318 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "parallel.h" - Class template "parallelSearch" definition.                                      *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+#include "search.h"
+#include "workpool.h"
+
+#define PARALLEL_POLL_MS 50 // milliseconds between polls of observer while waiting for tasks
+
+/*
+ * Backtracking search split across threads.  The search tree is cut
+ * 'splitDepth' blocks below the starting state; each partial solution
+ * at that depth becomes a task searched by its own "backtrackSearch"
+ * (with its own copy of the grid) on a "workStealingPool".
+ *
+ * Tasks are numbered in the order the sequential search would reach
+ * them and each task buffers its solutions, which are passed to the
+ * observer strictly in task order.  The observer therefore sees exactly
+ * the solutions, in exactly the order, of a single threaded search.
+ * All observer calls are made from the thread that called "run".
+ */
+template <int WORDS>
+class parallelSearch {
+ public:
+   parallelSearch(const placementTable<WORDS> &t, searchObserver &o,
+                  const int nThreads, const int depth)
+     : table(t), observer(o), threads(nThreads), splitDepth(depth) {
+      pruning   = false;
+      countOnly = false;
+      limit     = 0;
+   }
+
+   ~parallelSearch(void) {clearTasks();}
+
+   /*
+    * Turn dead region pruning (see "backtrackSearch") on or off.
+    */
+   void setPruning(bool p) {pruning = p;}
+
+   /*
+    * Count solutions without keeping them if 'c' is set: each task's
+    * count is passed to "searchObserver::solutionsCounted" instead of
+    * each solution to "searchObserver::solution", stopping at 'l'
+    * solutions in all if 'l' is not 0.
+    */
+   void setCountOnly(bool c, long l) {countOnly = c; limit = l;}
+
+   /*
+    * Find all solutions from the state described by 'occupied' and
+    * 'usedBlocks' (see "backtrackSearch::run").  Return true if the
+    * search ran to completion, false if halted by the observer.
+    */
+   bool run(const bitboard<WORDS> &occupied, const blockMask usedBlocks) {
+      clearTasks();
+      stop          = false;
+      solutionCount = 0;
+      nodes         = 0;
+      tested        = 0;
+      pruned        = 0;
+      percentSolved = 0;
+      completed     = 0;
+      stats.reset(table.getBlockCount());
+
+      piecePlacement prefix[MAX_NUMBER_BLOCKS];
+      int cell = occupied.firstClear(0, table.getCells());
+      if (cell == table.getCells())
+        return true; // nothing to solve
+      split(occupied, usedBlocks, cell, prefix, 0);
+
+      workStealingPool pool(threads);
+      for (int i = 0; i < (int)tasks.size(); ++i)
+        pool.add(std::bind(&parallelSearch::runTask, this, tasks[i]));
+      pool.start();
+
+      // pass on solutions in task order while tasks complete
+      int next = 0;
+      bool halted = false;
+      while (next < (int)tasks.size()) {
+         if (tasks[next]->done) {
+            if (!halted && !report(*tasks[next])) {
+               halted = true;
+               stop   = true;
+            }
+            nodes  += tasks[next]->nodes;
+            tested += tasks[next]->tested;
+            pruned += tasks[next]->pruned;
+            stats.merge(tasks[next]->stats, tasks[next]->prefixLength);
+            delete tasks[next];
+            tasks[next] = NULL;
+            ++next;
+            continue;
+         }
+         percentSolved = 100 * (double)completed / tasks.size();
+         long searched = nodes;
+         for (int i = next; i < (int)tasks.size(); ++i)
+           searched += tasks[i]->liveNodes;
+         if (!halted && !observer.poll(percentSolved, searched)) {
+            halted = true;
+            stop   = true;
+         }
+         std::unique_lock<std::mutex> guard(doneLock);
+         if (!tasks[next]->done)
+           taskDone.wait_for(guard, std::chrono::milliseconds(PARALLEL_POLL_MS));
+      }
+      pool.join();
+      stealCount = pool.getStealCount();
+      return !halted;
+   }
+
+   long   getSolutionCount(void) const {return solutionCount;}
+   long   getNodeCount(void) const     {return nodes;        }
+   long   getTestedCount(void) const   {return tested;       }
+   long   getPrunedCount(void) const   {return pruned;       }
+   double getPercentSolved(void) const {return percentSolved;}
+   int    getTaskCount(void) const     {return taskCount;    }
+   long   getStealCount(void) const    {return stealCount;   }
+
+   /*
+    * Return statistics of searches below split depth (see "stats.h").
+    */
+   const searchStats &getStats(void) const {return stats;}
+
+ private:
+   /*
+    * Partial solution at split depth, and the solutions found below it.
+    */
+   struct task {
+      bitboard<WORDS> occ;
+      blockMask       used;
+      int  prefixLength;
+      piecePlacement prefix[MAX_NUMBER_BLOCKS];
+      bool complete; // prefix is itself a solution
+      std::vector<piecePlacement> found;   // blocks of each solution below prefix
+      std::vector<int>            foundEnd; // end of each solution in 'found'
+      long foundCount; // solutions below prefix (if only counting, else 0)
+      long nodes,
+           tested,
+           pruned;
+      searchStats stats;
+      std::atomic<long> liveNodes; // nodes searched so far, while running
+      std::atomic<bool> done;
+   };
+
+   /*
+    * Collects solutions of one task on a worker thread.
+    */
+   class taskObserver : public searchObserver {
+    public:
+      taskObserver(task &t, const std::atomic<bool> &s, bool c)
+        : tk(t), stopFlag(s), counting(c) {}
+      bool solution(const piecePlacement *pieces, int n) {
+         if (counting)
+           ++tk.foundCount;
+         else {
+            tk.found.insert(tk.found.end(), pieces, pieces + n);
+            tk.foundEnd.push_back((int)tk.found.size());
+         }
+         return !stopFlag;
+      }
+      bool solutionsCounted(long) {return !stopFlag;} // tasks are not given a cache
+      bool poll(double, long nodes) {
+         tk.liveNodes = nodes;
+         return !stopFlag;
+      }
+    private:
+      task &tk;
+      const std::atomic<bool> &stopFlag;
+      bool counting;
+   };
+
+   /*
+    * Enumerate partial solutions 'splitDepth' blocks deep in the same
+    * order as "backtrackSearch" and make a task of each.
+    */
+   void split(const bitboard<WORDS> &occ, const blockMask used, const int cell,
+              piecePlacement *prefix, const int depth) {
+      if (depth == splitDepth) {
+         addTask(occ, used, prefix, depth, false);
+         return;
+      }
+      int fits = 0;
+      stats.node(depth);
+      for (int i = table.first(cell); i < table.last(cell); ++i) {
+         const placement<WORDS> &p = table[i];
+         if ((used >> p.piece.block) & 1)
+           continue;
+         stats.test(depth, p.piece.block);
+         if (!table.fits(p, occ))
+           continue;
+         stats.fit(depth, p.piece.block);
+         ++fits;
+         bitboard<WORDS> nextOcc = occ;
+         table.toggle(p, nextOcc);
+         prefix[depth] = p.piece;
+         int next = nextOcc.firstClear(cell + 1, table.getCells());
+         if (next == table.getCells())
+           addTask(nextOcc, used | ((blockMask)1 << p.piece.block), prefix, depth + 1, true);
+         else
+           split(nextOcc, used | ((blockMask)1 << p.piece.block), next, prefix, depth + 1);
+      }
+      if (fits == 0)
+        stats.deadEnd(depth, depth > 0 ? prefix[depth - 1].block : -1);
+   }
+
+   void addTask(const bitboard<WORDS> &occ, const blockMask used,
+                const piecePlacement *prefix, const int depth, const bool complete) {
+      task *t = new task;
+      t->occ          = occ;
+      t->used         = used;
+      t->prefixLength = depth;
+      for (int i = 0; i < depth; ++i)
+        t->prefix[i] = prefix[i];
+      t->complete   = complete;
+      t->nodes      = 0;
+      t->tested     = 0;
+      t->pruned     = 0;
+      t->foundCount = 0;
+      t->liveNodes  = 0;
+      t->done       = false;
+      tasks.push_back(t);
+      taskCount = (int)tasks.size();
+   }
+
+   /*
+    * Search below prefix of task 't' (called on worker thread).
+    */
+   void runTask(task *t) {
+      if (!t->complete && !stop) {
+         taskObserver o(*t, stop, countOnly);
+         backtrackSearch<WORDS> s(table, o);
+         s.setPruning(pruning);
+         s.run(t->occ, t->used);
+         t->nodes  = s.getNodeCount();
+         t->tested = s.getTestedCount();
+         t->pruned = s.getPrunedCount();
+         t->stats  = s.getStats();
+      }
+      {
+         std::lock_guard<std::mutex> guard(doneLock);
+         t->done = true;
+         ++completed;
+      }
+      taskDone.notify_one();
+   }
+
+   /*
+    * Pass solutions of task 't' to observer (prefix + blocks below it).
+    * Return false if the observer halted the search.
+    */
+   bool report(const task &t) {
+      piecePlacement pieces[MAX_NUMBER_BLOCKS];
+      int i, j, start = 0;
+      for (i = 0; i < t.prefixLength; ++i)
+        pieces[i] = t.prefix[i];
+      if (t.complete) {
+         ++solutionCount;
+         return observer.solution(pieces, t.prefixLength);
+      }
+      if (countOnly) {
+         long n = t.foundCount;
+         if (limit > 0 && solutionCount + n > limit)
+           n = limit - solutionCount; // as many as a single threaded search would count
+         solutionCount += n;
+         return n == 0 || observer.solutionsCounted(n);
+      }
+      for (i = 0; i < (int)t.foundEnd.size(); ++i) {
+         for (j = start; j < t.foundEnd[i]; ++j)
+           pieces[t.prefixLength + j - start] = t.found[j];
+         ++solutionCount;
+         if (!observer.solution(pieces, t.prefixLength + t.foundEnd[i] - start))
+           return false;
+         start = t.foundEnd[i];
+      }
+      return true;
+   }
+
+   void clearTasks(void) {
+      for (int i = 0; i < (int)tasks.size(); ++i)
+        delete tasks[i];
+      tasks.clear();
+   }
+
+   const placementTable<WORDS> &table;
+   searchObserver &observer;
+   int threads,
+       splitDepth,
+       taskCount;
+   bool pruning,
+        countOnly; // see "setCountOnly"
+   long limit;
+   std::vector<task *> tasks;
+   std::atomic<bool> stop;
+   std::atomic<int>  completed;
+   std::mutex doneLock;
+   std::condition_variable taskDone;
+   long solutionCount,
+        nodes,
+        tested,
+        pruned,
+        stealCount;
+   double percentSolved;
+   searchStats stats;
+};
+
+#endif
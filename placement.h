@@ -0,0 +1,277 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "placement.h" - Class template "placementTable" definition.                                     *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <vector>
+
+#include "bitboard.h"
+#include "block.h"
+
+/*
+ * Block, orientation and puzzle grid index of blocks TL square.
+ * Enough to describe the position of one block in a solution.
+ */
+struct piecePlacement {
+   int block,       // index of block in block set
+       orientation, // (0-7) see "block::changeOrientation"
+       anchor;      // grid index (r * width + c) of blocks TL square
+};
+
+#define INLINE_MASK_WORDS 2 // largest bitboard (in words) held whole by each placement
+
+/*
+ * One legal position of one unique orientation of one block.
+ *
+ * On grids of up to INLINE_MASK_WORDS words (128 squares) the placement
+ * holds the mask of grid squares it covers.  On larger grids it holds
+ * only the words of that mask that are not zero, 'length' of them from
+ * word 'first' of the grid, kept at index 'start' of the mask pool of
+ * its "placementTable".  The table then grows with the size of the
+ * blocks rather than the area of the grid, and testing a placement
+ * touches only the words of the grid it covers.
+ *
+ * Both forms are used through "placementTable::fits", "toggle" and
+ * "getMask", which pass the pool to the functions below.
+ */
+template <int WORDS, bool WHOLE = (WORDS <= INLINE_MASK_WORDS)>
+struct placement {
+   bitboard<WORDS> mask;  // grid squares covered
+   piecePlacement  piece;
+
+   bool fits(const bitboard<WORDS> &occ, const bbWord *) const {return !occ.intersects(mask);}
+   void toggle(bitboard<WORDS> &occ, const bbWord *) const     {occ ^= mask;               }
+   void getMask(bitboard<WORDS> &m, const bbWord *) const      {m = mask;                  }
+   void setMask(const bitboard<WORDS> &m, std::vector<bbWord> &) {mask = m;                }
+   void copyMask(const placement &, const bbWord *, std::vector<bbWord> &) {}
+};
+
+template <int WORDS>
+struct placement<WORDS, false> {
+   piecePlacement piece;
+   int first,  // first word of grid holding a square covered
+       length, // number of words from 'first' on holding squares covered
+       start;  // index in mask pool of word 'first' of mask
+
+   bool fits(const bitboard<WORDS> &occ, const bbWord *pool) const {
+      const bbWord *m = pool + start;
+      for (int i = 0; i < length; ++i)
+        if (occ.word(first + i) & m[i])
+          return false;
+      return true;
+   }
+
+   void toggle(bitboard<WORDS> &occ, const bbWord *pool) const {
+      const bbWord *m = pool + start;
+      for (int i = 0; i < length; ++i)
+        occ.word(first + i) ^= m[i];
+   }
+
+   void getMask(bitboard<WORDS> &m, const bbWord *pool) const {
+      m.clear();
+      for (int i = 0; i < length; ++i)
+        m.word(first + i) = pool[start + i];
+   }
+
+   void setMask(const bitboard<WORDS> &m, std::vector<bbWord> &pool) {
+      int last = WORDS - 1;
+      first = 0;
+      while (first < last && !m.word(first))
+        ++first;
+      while (last > first && !m.word(last))
+        --last;
+      length = last - first + 1;
+      start  = (int)pool.size();
+      for (int i = first; i <= last; ++i)
+        pool.push_back(m.word(i));
+   }
+
+   // make this placement's mask a copy of that of 'p' (mask in 'srcPool')
+   void copyMask(const placement &p, const bbWord *srcPool, std::vector<bbWord> &pool) {
+      start = (int)pool.size();
+      pool.insert(pool.end(), srcPool + p.start, srcPool + p.start + p.length);
+   }
+};
+
+/*
+ * Every legal placement of every unique orientation of every block in
+ * a block set, grouped by anchor (the first square covered when moving
+ * through the grid left->right & top->bottom, ie. the blocks TL square).
+ * The placements anchored at grid index 'i' are those numbered from
+ * "first(i)" up to but not including "last(i)", and are held (with
+ * their masks, see "placement") in anchor order.
+ */
+template <int WORDS>
+class placementTable {
+ public:
+   placementTable(void) {cells = width = 0;}
+
+   /*
+    * Enumerate placements of blocks 'blocks[0..n-1]' in an empty
+    * puzzle grid 'height' x 'width' squares, leaving out those that
+    * cover a square in 'blocked' (if given).  Block 'i' is given
+    * index 'i' in the "piecePlacement" of each placement.
+    */
+   void build(block blocks[], const int n, const int height, const int width,
+              const bitboard<WORDS> *blocked = NULL) {
+      std::vector<shape> shapes;
+      shape s;
+      placement<WORDS> p;
+      bitboard<WORDS> mask;
+      int i, o, r, c, k;
+
+      clear();
+      cells       = height * width;
+      this->width = width;
+      blockSize.assign(n, 0);
+
+      // squares of each unique orientation of each block, relative to its TL square
+      for (i = 0; i < n; ++i) {
+         block *bPtr = &blocks[i];
+         int oldOrientation = bPtr->getOrientation();
+         for (o = 0; o < 8; ++o) {
+            if (!bPtr->uniqueOrientation(o))
+              continue;
+            bPtr->changeOrientation(o);
+            s.block       = i;
+            s.orientation = o;
+            s.squares.clear();
+            for (r = 0; r < bPtr->getHeight(); ++r)
+              for (c = 0; c < bPtr->getWidth(); ++c)
+                if (bPtr->getGrid(r, c)) {
+                   pos q;
+                   q.r = r;
+                   q.c = c - bPtr->getTLcol();
+                   s.squares.push_back(q);
+                }
+            shapes.push_back(s);
+            blockSize[i] = (int)s.squares.size();
+         }
+         bPtr->changeOrientation(oldOrientation);
+      }
+
+      // placements anchored on each square in turn, in block/orientation order
+      mask.clear();
+      start.assign(cells + 1, 0);
+      for (r = 0; r < height; ++r)
+        for (c = 0; c < width; ++c) {
+           for (i = 0; i < (int)shapes.size(); ++i) {
+              // superimpose block over grid with TL on (r, c)
+              const std::vector<pos> &squares = shapes[i].squares;
+              for (k = 0; k < (int)squares.size(); ++k) {
+                 int gr = r + squares[k].r,
+                     gc = c + squares[k].c;
+                 if (gr >= height || gc < 0 || gc >= width
+                     || (blocked != NULL && blocked->test(gr * width + gc)))
+                   break;
+                 mask.set(gr * width + gc);
+              }
+              if (k == (int)squares.size()) {
+                 p.piece.block       = shapes[i].block;
+                 p.piece.orientation = shapes[i].orientation;
+                 p.piece.anchor      = r * width + c;
+                 p.setMask(mask, pool);
+                 list.push_back(p);
+              }
+              while (--k >= 0) // leave 'mask' clear for next placement
+                mask.reset((r + squares[k].r) * width + c + squares[k].c);
+           }
+           start[r * width + c + 1] = (int)list.size();
+        }
+   }
+
+   /*
+    * Make this table a copy of 'src' containing only the placements
+    * 'i' for which 'keep[i]' is true.
+    */
+   void filter(const placementTable &src, const std::vector<bool> &keep) {
+      int i, j;
+      clear();
+      cells     = src.cells;
+      width     = src.width;
+      blockSize = src.blockSize;
+      start.assign(cells + 1, 0);
+      for (i = 0; i < cells; ++i) {
+         for (j = src.first(i); j < src.last(i); ++j)
+           if (keep[j]) {
+              list.push_back(src.list[j]);
+              list.back().copyMask(src.list[j], src.pool.data(), pool);
+           }
+         start[i + 1] = (int)list.size();
+      }
+   }
+
+   /*
+    * Free the table's memory.
+    */
+   void clear(void) {
+      cells = width = 0;
+      std::vector<int>().swap(blockSize);
+      std::vector<placement<WORDS> >().swap(list);
+      std::vector<bbWord>().swap(pool);
+      std::vector<int>().swap(start);
+   }
+
+   int getCells(void) const {return cells;                }
+   int getWidth(void) const {return width;                }
+   int getCount(void) const {return (int)list.size();     }
+
+   /*
+    * Return number of blocks in block set, and number of squares in block 'i'.
+    */
+   int getBlockCount(void) const  {return (int)blockSize.size();}
+   int getBlockSize(int i) const  {return blockSize[i];         }
+   int first(int i) const   {return start[i];             }
+   int last(int i) const    {return start[i + 1];         }
+
+   const placement<WORDS> &operator[](int i) const {return list[i];}
+
+   /*
+    * Test whether placement 'p' (of this table) covers no square of 'occ'.
+    */
+   bool fits(const placement<WORDS> &p, const bitboard<WORDS> &occ) const {
+      return p.fits(occ, pool.data());
+   }
+
+   /*
+    * Add the squares of placement 'p' to 'occ', or remove them if it
+    * has been added already.
+    */
+   void toggle(const placement<WORDS> &p, bitboard<WORDS> &occ) const {p.toggle(occ, pool.data());}
+
+   /*
+    * Set 'mask' to the squares covered by placement 'p'.
+    */
+   void getMask(const placement<WORDS> &p, bitboard<WORDS> &mask) const {p.getMask(mask, pool.data());}
+
+   /*
+    * Return approximate number of bytes used by the table.
+    */
+   size_t getBytes(void) const {
+      return list.size() * sizeof(placement<WORDS>) + pool.size() * sizeof(bbWord)
+             + start.size() * sizeof(int);
+   }
+
+ private:
+   // one unique orientation of a block
+   struct shape {
+      int block,
+          orientation;
+      std::vector<pos> squares; // relative to TL square
+   };
+
+   int cells, // number of squares in puzzle grid
+       width; // width of puzzle grid
+   std::vector<int> blockSize; // number of squares in each block
+   std::vector<placement<WORDS> > list;
+   std::vector<bbWord> pool; // masks of placements not holding their own (see "placement")
+   std::vector<int> start; // index in 'list' of first placement anchored at each square
+};
+
+#endif
@@ -0,0 +1,22 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "pos.h" - Struct "pos" definition.                                                              *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef POS_H
+#define POS_H
+
+/*
+ * Position of a square in a grid (row, column).
+ */
+struct pos {
+   int r, c;
+
+   bool operator==(const pos &p) const {return r == p.r && c == p.c;}
+   bool operator!=(const pos &p) const {return r != p.r || c != p.c;}
+};
+
+#endif
@@ -6,26 +6,60 @@
 *                                                                                                 *
 \*************************************************************************************************/
 
+#include <string.h>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
 #include "puzzle.h"
 
+using namespace std;
+
 // PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
 
 /*
  * Constructor.
  */
 puzzle::puzzle(void) {
-   currentBlockPtr = NULL; // initialise Q
+   currentBlock    = NO_BLOCK;
+   numberOfBlocks  = 0;
+   placedCount     = 0;
+   inGrid          = 0;
+   waiting         = 0;
+   nextBlock       = 0;
+   solutionFileName = DEFAULT_SOLUTION_FILE;
+   format          = BINARY_SOLUTIONS;
+   view            = NULL;
+   engine          = BACKTRACKING_ENGINE;
+   threads         = 1;
+   splitDepth      = DEFAULT_SPLIT_DEPTH;
+   breakSymmetry   = false;
+   expandSymmetry  = false;
+   symmetryCount   = 1;
+   pruning         = false;
+   prunedCount     = 0;
+   nodeCount       = 0;
+   testedCount     = 0;
+   estimatedNodes  = 0;
+   estimateProgress = false;
+   countOnly       = false;
+   limitReached    = false;
+   deadline        = chrono::steady_clock::time_point::max();
+   cancelFlag      = NULL;
+   watcher         = NULL;
+   solutionLimit   = 0;
+   cacheBytes      = 0;
+   cachePolicy     = REPLACE_CHEAPEST;
+   keepCache       = false;
+   memset(&cacheCounts, 0, sizeof(cacheCounts));
    
-   height = 8; // initailize grid height
-   width  = 8; // initialize grid width
-
-   for (int r = 0; r < height; ++r)
-     for (int c = 0; c < width; ++c)
-       grid[r][c] = RGB(0, 0, 0);
-
-   nextEmptyPos.r = nextEmptyPos.c = 0;
    strcpy(textBuffer, "");
-   solving = foundSolution = false;
+   strcpy(report, "");
+   timeTaken = 0;
+   solving = foundSolution = completed = false;
+
+   height = width = 0;
+   setBoard(board()); // initialise grid (8 x 8, all open)
 }
 
 /*
@@ -35,28 +69,40 @@ puzzle::~puzzle(void) {
 }
 
 /*
- * Serve block from 'Q' and set as "currentBlock".
- * Return true if successful, false otherwise.
+ * Attach user interface 'v', or detach it if NULL.
+ */
+void puzzle::setView(puzzleView *v) {
+   view = v;
+   if (view != NULL)
+     view->setGridSize(height, width);
+}
+
+/*
+ * Take the next block not in the puzzle grid (in block set order,
+ * starting after the one last taken) as "currentBlock".
  */
 void puzzle::pickUpBlock(void) {
-   assert(currentBlockPtr == NULL);
-   Q.serve(currentBlockPtr);
+   assert(currentBlock == NO_BLOCK && waiting != 0);
+   blockMask later = nextBlock < MAX_NUMBER_BLOCKS ? waiting >> nextBlock << nextBlock : 0;
+   currentBlock = lowestBit(later != 0 ? later : waiting); // wrapping round to block 0
+   waiting     &= ~((blockMask)1 << currentBlock);
+   nextBlock    = currentBlock + 1;
    if (!solving) {
       // reset orientation
-      currentBlockPtr->changeOrientation(0);
+      heldBlock().changeOrientation(0);
       // set holdPos to original
-      currentBlockPtr->resetHoldPos();
+      heldBlock().resetHoldPos();
    }
 }
 
 /*
- * Append "currentBlock" to 'Q' and set "currentBlockPtr" to NULL.
- * Return true if successful, false otherwise.
+ * Return "currentBlock" to the blocks not in the puzzle grid, leaving
+ * no block held.
  */
 void puzzle::putDownBlock(void) {
-   assert(currentBlockPtr != NULL);
-   Q.append(currentBlockPtr);
-   currentBlockPtr = NULL;
+   assert(currentBlock != NO_BLOCK);
+   waiting     |= (blockMask)1 << currentBlock;
+   currentBlock = NO_BLOCK;
 }
 
 /*
@@ -68,7 +114,7 @@ void puzzle::putDownBlock(void) {
  *               (0, 1, 2, 3) *90 degrees clockwise)
  */
 inline void puzzle::reorientBlock(int o) {
-   currentBlockPtr->changeOrientation(o);
+   heldBlock().changeOrientation(o);
 }
 
 /*
@@ -82,7 +128,7 @@ inline void puzzle::reorientBlock(int o) {
  *      A block with no symmetry has 8 unique orientations (0-7).
  */
 inline bool puzzle::blockOrientUnique(int o) {
-   return currentBlockPtr->uniqueOrientation(o);
+   return heldBlock().uniqueOrientation(o);
 }
 
 /*
@@ -93,9 +139,9 @@ inline bool puzzle::blockOrientUnique(int o) {
 void puzzle::drawBlock(pos p) {
    assert(p.r >= 0 && p.r < height && p.c >= 0 && p.c < width);
    // correct for holdPos of block
-   p.r -= currentBlockPtr->getHoldPos().r; 
-   p.c -= currentBlockPtr->getHoldPos().c;
-   drawBlock(p, currentBlockPtr->getColour());
+   p.r -= heldBlock().getHoldPos().r; 
+   p.c -= heldBlock().getHoldPos().c;
+   drawBlock(p, heldBlock().getColour());
 }
 
 /*
@@ -106,8 +152,8 @@ void puzzle::drawBlock(pos p) {
 void puzzle::eraseBlock(pos p) {
    assert(p.r >= 0 && p.r < height && p.c >= 0 && p.c < width);
    // correct for holdPos of block
-   p.r -= currentBlockPtr->getHoldPos().r;
-   p.c -= currentBlockPtr->getHoldPos().c;
+   p.r -= heldBlock().getHoldPos().r;
+   p.c -= heldBlock().getHoldPos().c;
    drawBlock(p, RGB(0, 0, 0));
 }
 
@@ -129,32 +175,44 @@ bool puzzle::addBlock(pos p) {
 
    if (!solving) {
       // correct for holdPos and TL of block
-      p.r -= currentBlockPtr->getHoldPos().r; 
-      p.c -= currentBlockPtr->getHoldPos().c - currentBlockPtr->getTLcol();
+      p.r -= heldBlock().getHoldPos().r; 
+      p.c -= heldBlock().getHoldPos().c - heldBlock().getTLcol();
 
       if (p.r < 0 || p.r >= height || p.c < 0 || p.c >= width)
         return false;
    }
 
    if (blockFits(p)) {
+      // update occupied squares
+      int shift = maskShift(p);
+      if (gridWords == 1)
+        occupied.word(0) |= heldBlock().getMask()[0] << shift;
+      else {
+         puzzleBitboard m;
+         m.loadShifted(heldBlock().getMask(), heldBlock().getMaskWords(), shift);
+         occupied |= m;
+      }
+
       // update grid array
-      int blockH = currentBlockPtr->getHeight(),
-          blockW = currentBlockPtr->getWidth(),
-          TLcol  = currentBlockPtr->getTLcol(),
-          colour = currentBlockPtr->getColour(),
+      int blockH = heldBlock().getHeight(),
+          blockW = heldBlock().getWidth(),
+          TLcol  = heldBlock().getTLcol(),
+          colour = heldBlock().getColour(),
           r, c;
       for (r = 0; r < blockH; ++r)
-	     for (c = 0; c < blockW; ++c)
-          if (currentBlockPtr->getGrid(r, c))
-          grid[p.r + r][p.c + c - TLcol] = colour;
+        for (c = 0; c < blockW; ++c)
+          if (heldBlock().getGrid(r, c))
+            grid[p.r + r][p.c + c - TLcol] = colour;
 
-      if (grid[nextEmptyPos.r][nextEmptyPos.c] != RGB(0, 0, 0))
+      if (nextEmptyPos.r < height
+          && occupied.test(nextEmptyPos.r * width + nextEmptyPos.c))
         // nextEmptyPos is no longer empty
         nextEmptyPos = findNextEmptyPos();
 
-      currentBlockPtr->setPuzPos(p); // set puzPos
-      S.push(currentBlockPtr);
-      currentBlockPtr = NULL;
+      heldBlock().setPuzPos(p); // set puzPos
+      placed[placedCount++] = currentBlock;
+      inGrid      |= (blockMask)1 << currentBlock;
+      currentBlock = NO_BLOCK;
       return true; // block added to puzzle
    }
    return false; // block doesn't fit
@@ -167,8 +225,9 @@ bool puzzle::addBlock(pos p) {
  * Return true if block removed, else false.
  */
 inline void puzzle::removeBlock(void) {
-   assert(currentBlockPtr == NULL);
-   S.pop(currentBlockPtr);
+   assert(currentBlock == NO_BLOCK && placedCount > 0);
+   currentBlock = placed[--placedCount];
+   inGrid      &= ~((blockMask)1 << currentBlock);
    updateGrid();
 }
 
@@ -179,27 +238,20 @@ inline void puzzle::removeBlock(void) {
  */
 bool puzzle::removeBlock(pos p) {
    assert(p.r >= 0 && p.r < height && p.c >= 0 && p.c < width);
-   assert(currentBlockPtr == NULL);
-   if (grid[p.r][p.c] != RGB(0, 0, 0)) {
-      // find block in stack
-      stack<block *> tempS(S.getCount());
-      while (!S.empty()) {
-         S.pop(currentBlockPtr);
-         if (currentBlockPtr->getColour() == grid[p.r][p.c])
-           break;
-         else
-           tempS.push(currentBlockPtr); // wrong block
-      }
-      // restore stack
-      block *bPtr;
-      while (!tempS.empty()) {
-         tempS.pop(bPtr);
-         S.push(bPtr);
-      }
+   assert(currentBlock == NO_BLOCK);
+   if (grid[p.r][p.c] != RGB(0, 0, 0) && !blocked.test(p.r * width + p.c)) {
+      // find block in grid (the last added, if several have its colour)
+      int i = placedCount - 1;
+      while (blocks[placed[i]].getColour() != grid[p.r][p.c])
+        --i;
+      currentBlock = placed[i];
+      for (--placedCount; i < placedCount; ++i)
+        placed[i] = placed[i + 1];
+      inGrid &= ~((blockMask)1 << currentBlock);
       // set holdPos of block
-      p.r -= currentBlockPtr->getPuzPos().r;
-      p.c -= currentBlockPtr->getPuzPos().c - currentBlockPtr->getTLcol();
-      currentBlockPtr->setHoldPos(p); 
+      p.r -= heldBlock().getPuzPos().r;
+      p.c -= heldBlock().getPuzPos().c - heldBlock().getTLcol();
+      heldBlock().setHoldPos(p); 
       updateGrid();
       return true;
    }
@@ -207,18 +259,27 @@ bool puzzle::removeBlock(pos p) {
 }
 
 /*
- * Print puzzle grid to screen as text.
+ * Print puzzle grid to 'out' as text, one letter per block
+ * ('A' = first block in block set, then 'Z', 'a' to 'z' and digits for
+ * large block sets), '-' for empty squares and '#' or ' ' for blocked
+ * squares and squares outside the board.
  */
-void puzzle::print(void) {
-   int r, c;
+void puzzle::print(ostream &out) {
+   static const char letters[MAX_NUMBER_BLOCKS + 1]
+     = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789@%";
+   int r, c, i;
    for (r = 0; r < height; ++r) {
-      for (c = 0; c < width; ++c)
-        if (grid[r][c] != RGB(0, 0, 0)) {
-           // PROBLEM: need to set text colour then use (char)219
-           cout << (char)grid[r][c] << (char)grid[r][c];
-        }
-        else cout << "--";
-      cout << endl;
+      for (c = 0; c < width; ++c) {
+         if (blocked.test(r * width + c)) {
+            out << (shape.getSquare(r, c) == BLOCKED_SQUARE ? '#' : ' ');
+            continue;
+         }
+         for (i = 0; i < numberOfBlocks; ++i)
+           if (grid[r][c] != RGB(0, 0, 0) && blocks[i].getColour() == grid[r][c])
+             break;
+         out << (i < numberOfBlocks ? letters[i] : '-');
+      }
+      out << endl;
    }
 }
 
@@ -227,40 +288,41 @@ void puzzle::print(void) {
  */
 void puzzle::draw(void) {
    int r, c;
+   beginDraw();
    for (r = 0; r < height; ++r)
      for (c = 0; c < width; ++c)
        drawSquare(grid[r][c], r, c);
+   endDraw();
+}
+
+/*
+ * Start and end a run of squares drawn to be shown at once (see
+ * "puzzleView::beginDraw").
+ */
+void puzzle::beginDraw(void) {
+   if (view != NULL)
+     view->beginDraw();
+}
+
+void puzzle::endDraw(void) {
+   if (view != NULL)
+     view->endDraw();
 }
 
 /*
  * Draw text in text area of main window.
  * If empty string is supplied will redraw most recent message.
  */
-void puzzle::drawText(char *stringPtr) {
-   HDC hdc = GetDC(main_window_handle);
-   
-   // clear text area
-   HPEN pen = CreatePen(PS_SOLID, 0, RGB(200, 200, 200));
-   HPEN old_pen = (HPEN)SelectObject(hdc, pen);   
-   HBRUSH brush = CreateSolidBrush(RGB(200, 200, 200));
-   HBRUSH old_brush = (HBRUSH)SelectObject(hdc, brush);
-   Rectangle(hdc, 0, height * SQUARE_SIZE,
-             width * SQUARE_SIZE, height * SQUARE_SIZE + 16);
-   SelectObject(hdc, old_pen);
-   SelectObject(hdc, old_brush);
-   DeleteObject(pen);
-   DeleteObject(brush);
-
-   // draw text
-   COLORREF oldTextColour = SetTextColor(hdc, RGB(0, 0, 0)),
-            oldBkColour   = SetBkColor(hdc, RGB(200, 200, 200));
-   if (strcmp(stringPtr, "") != 0) // if not empty string
-     strcpy(textBuffer, stringPtr);
-   TextOut (hdc, 0, height * SQUARE_SIZE, textBuffer, strlen(textBuffer));
-   SetTextColor(hdc, oldTextColour);
-   SetBkColor  (hdc, oldBkColour);
-
-   ReleaseDC(main_window_handle, hdc);
+void puzzle::drawText(const char *stringPtr) {
+   if (strcmp(stringPtr, "") != 0) { // if not empty string (may be 'textBuffer' itself)
+      size_t n = strlen(stringPtr);
+      if (n > sizeof(textBuffer) - 1)
+        n = sizeof(textBuffer) - 1;
+      memmove(textBuffer, stringPtr, n);
+      textBuffer[n] = '\0';
+   }
+   if (view != NULL)
+     view->drawText(textBuffer);
 }
 
 /*
@@ -268,140 +330,685 @@ void puzzle::drawText(char *stringPtr) {
  * state.  Return the number of solutions found.
  */
 int puzzle::solve(void) {
-   assert(currentBlockPtr == NULL);
+   assert(currentBlock == NO_BLOCK);
    solutionCount = 0;
    percentSolved = 0;
-   ofstream file("solution.dat");
-   stack<block *> tempS(S.getCount());
+   limitReached  = false;
+   completed     = false;
+   memset(&cacheCounts, 0, sizeof(cacheCounts));
+   if (!countOnly) {
+      solutionsRead.close(); // file is about to be overwritten
+      solutionLines.close();
+      textSolutionIndex::discard(solutionFileName.c_str());
+   }
 
-   file << S; // save initial state of puzzle to first line of solution file
+   // blocks already in puzzle are not available to the search
+   blockMask usedBlocks = inGrid;
+   solutionFileInfo info;
+   getPieces(info.initial);
+
+   info.height     = height;
+   info.width      = width;
+   info.blockCount = numberOfBlocks;
+   info.hash       = blockHash;
+
+   // save initial state of puzzle at start of solution file (unless only counting)
+   vector<char> fileBuffer; // must outlive 'file'
+   ofstream file;
+   solutionWriter writer;
+   if (!countOnly && format == TEXT_SOLUTIONS) {
+      fileBuffer.resize(SOLUTION_FILE_BUFFER_SIZE);
+      file.rdbuf()->pubsetbuf(&fileBuffer[0], fileBuffer.size());
+      file.open(solutionFileName.c_str());
+      if (!file)
+        return -1;
+      writeTextSolution(file, info.initial.empty() ? NULL : &info.initial[0],
+                        (int)info.initial.size());
+      output.start(bind(&puzzle::writeTextSolution, this, ref(file),
+                        placeholders::_1, placeholders::_2), numberOfBlocks);
+   }
+   else if (!countOnly) {
+      if (!writer.open(solutionFileName.c_str(), info))
+        return -1;
+      output.start(bind(&solutionWriter::write, &writer, placeholders::_1, placeholders::_2),
+                   numberOfBlocks);
+   }
 
-   // empty stack to enable solve of partially complete puzzle
-   while (S.pop(currentBlockPtr))
-     tempS.push(currentBlockPtr);
-   currentBlockPtr = NULL;
+   // draw snapshots of search on watcher's thread
+   bool watched = watcher != NULL && engine == BACKTRACKING_ENGINE && threads == 1,
+        traced  = true;
+   if (watched) {
+      snapshotPainter painter;
+      vector<COLORREF> colours;
+      getGridColours(colours);
+      painter.setup(blocks.data(), numberOfBlocks, height, width, colours);
+      traced = watcher->start(painter, info);
+   }
 
-   int startTime = GetTickCount();  // start timing
+   startTime = chrono::steady_clock::now(); // start timing
    solving = true;
-   bool foundAllSolutions = solveRecursively(file);
+   bool foundAllSolutions = gridWords == 1 ? runSearch(smallTable, usedBlocks, watched)
+                          : gridWords == 2 ? runSearch(mediumTable, usedBlocks, watched)
+                                           : runSearch(largeTable, usedBlocks, watched);
+   output.finish(); // write solutions still queued
+   writer.close();
+   if (watched)
+     watcher->stop();
    solving = false;
-   int finishTime = GetTickCount(); // stop  timing
-   float timeTaken = float(finishTime - startTime) / 1000; // calculate time taken in seconds
+   completed = foundAllSolutions && !limitReached;
+   timeTaken = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
 
    drawText(" "); // clear text area of percentage complete message
-   char buffer[100]; // NOTE: problems can occur if message below greater in size than buffer
+   char *buffer = report; // NOTE: problems can occur if message below greater in size than buffer
 
-   if (foundAllSolutions)
+   if (limitReached)
+     sprintf(buffer, "Stopped at solution %d (solution limit).\n"
+                     "Time taken: %.2f seconds",
+             solutionCount, timeTaken);
+   else if (foundAllSolutions && symmetryCount > 1)
+     sprintf(buffer, "%d solutions were found,\n"
+                     "each one of %d symmetric solutions.\n"
+                     "Time taken: %.2f seconds",
+             solutionCount, symmetryCount, timeTaken);
+   else if (foundAllSolutions)
      sprintf(buffer, "%d solutions were found.\n"
                      "Time taken: %.2f seconds",
              solutionCount, timeTaken);
    else {
-      // remove blocks placed during solve
-      while (!S.empty()) {
-         removeBlock();
-         putDownBlock();
-      }
       sprintf(buffer, "%2.1f%% through solution process,\n"
                       "%d solutions were found.\n"
                       "Time taken: %.2f seconds",
               percentSolved, solutionCount, timeTaken);
    }
+   if (pruning && engine == BACKTRACKING_ENGINE)
+     sprintf(buffer + strlen(buffer), "\nDead ends pruned: %ld", prunedCount);
+   if (cacheBytes > 0 && engine == BACKTRACKING_ENGINE && threads == 1)
+     sprintf(buffer + strlen(buffer), "\nCache hits: %ld of %ld",
+             cacheCounts.hits, cacheCounts.hits + cacheCounts.misses);
+   if (countOnly)
+     strcat(buffer, "\nSolutions were counted, not saved.");
+   if (!traced)
+     strcat(buffer, "\nSearch trace file could not be written.");
+
+   if (view != NULL)
+     view->showMessage(buffer);
 
-
-   MessageBox(main_window_handle, buffer, "BlockPuzzle", MB_OK);
-
-   // restore stack
-   while (tempS.pop(currentBlockPtr))
-     S.push(currentBlockPtr);
-
-   currentBlockPtr = NULL;
    return solutionCount;
 }
 
 /*
- * Read the "solutionNo"th solution from the file "solution.dat",
+ * Read the "solutionNo"th solution from the solution file,
  * add blocks to the puzzle in the way described,
  * then draw the solved puzzle.
+ * Blocks are removed again afterwards unless 'keep' is set.
  */
-void puzzle::viewSolution(int solutionNo) {
-   assert(currentBlockPtr == NULL);
-   assert(solutionCount > 0);
-   assert(solutionNo > 0 && solutionNo <= solutionCount);
+bool puzzle::viewSolution(int solutionNo, bool keep) {
+   assert(currentBlock == NO_BLOCK);
+   assert(solutionNo > 0);
 
-   ifstream inputSolnFile("solution.dat");
-   int i, bOrientation, bCount;
-   COLORREF bColour;
+   std::vector<piecePlacement> pieces;
+   int bCount;
+   if (!openSolutionFile())
+     return false;
+   if (solutionsRead.isOpen()) {
+      // binary file: solution is at fixed offset
+      const solutionFileInfo &info = solutionsRead.getInfo();
+      if (info.hash != blockHash || info.height != height || info.width != width
+          || !solutionsRead.read(solutionNo - 1, pieces) || !addPieces(pieces))
+        return false;
+      bCount = (int)pieces.size();
+   }
+   else {
+      // text file: line after initial state and preceding solutions
+      const char *text;
+      size_t length;
+      if (!solutionLines.line(solutionNo, text, length))
+        return false;
+      istringstream line(string(text, length));
+      solving = true; // so that add/removeBlock() do not draw
+      bCount = addTextSolution(line, pieces);
+      solving = false;
+      if (bCount < 0)
+        return false;
+   }
+   draw();
+
+   sprintf(textBuffer, "Solution %d.", solutionNo);
+   drawText(textBuffer);
+
+   solving = true; // so that removeBlock() does not draw
+   for (int j = 0; j < bCount && !keep; ++j) {
+      removeBlock();
+      putDownBlock();
+   }
+   solving = false; // allowing add/removeBlock() to draw again
+   return true;
+}
+
+/*
+ * Estimate search "solve" would make from the puzzles current state.
+ */
+void puzzle::estimate(const int probes, double &nodes, double &solutions, double &seconds) {
+   assert(currentBlock == NO_BLOCK);
+   blockMask usedBlocks = inGrid;
+   if (gridWords == 1)
+     estimateSearch(smallTable, usedBlocks, probes, nodes, solutions, seconds);
+   else if (gridWords == 2)
+     estimateSearch(mediumTable, usedBlocks, probes, nodes, solutions, seconds);
+   else
+     estimateSearch(largeTable, usedBlocks, probes, nodes, solutions, seconds);
+}
+
+/*
+ * Return number of placements in the placement table searched.
+ */
+int puzzle::getPlacementCount(void) {
+   return gridWords == 1 ? smallTable.getCount()
+        : gridWords == 2 ? mediumTable.getCount() : largeTable.getCount();
+}
+
+/*
+ * Return memory used by the placement table searched.
+ */
+size_t puzzle::getPlacementBytes(void) {
+   return gridWords == 1 ? smallTable.getBytes()
+        : gridWords == 2 ? mediumTable.getBytes() : largeTable.getBytes();
+}
 
-   for (i = 0; i < solutionNo; ++i)
-     while (inputSolnFile.get() != '\n');
+/*
+ * Return number of solutions in the solution file, or -1 if it
+ * cannot be read.
+ */
+long long puzzle::countSolutions(void) {
+   if (!openSolutionFile())
+     return -1;
+   if (solutionsRead.isOpen())
+     return solutionsRead.getCount();
+   long long lines = solutionLines.getLineCount();
+   return lines > 0 ? lines - 1 : 0; // not counting initial state
+}
 
-   bCount = 0;
+/*
+ * Draw snapshots in trace file 'fileName' 'speed' times as fast as they
+ * were recorded (0 = as fast as possible).  Return number drawn, or -1
+ * if the file is not a trace of a search of this puzzle.
+ */
+long puzzle::replayTrace(const char *fileName, const double speed) {
+   assert(currentBlock == NO_BLOCK);
+   ifstream file(fileName);
+   solutionFileInfo info;
+   if (!file || !readTraceHeader(file, info) || info.height != height || info.width != width
+       || info.blockCount != numberOfBlocks || info.hash != blockHash)
+     return -1;
+
+   // state search started from
+   beginDraw();
+   removeAllBlocks();
+   bool ok = addPieces(info.initial);
+   draw();
+   endDraw();
+   if (!ok)
+     return -1;
+   snapshotPainter painter;
+   vector<COLORREF> colours;
+   getGridColours(colours);
+   painter.setup(blocks.data(), numberOfBlocks, height, width, colours);
+
+   searchSnapshot s;
+   long frames = 0;
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   solving = true;
+   while (solving && readTraceFrame(file, s)) {
+      // wait until snapshot is due, handling user input meanwhile
+      chrono::steady_clock::time_point due = start;
+      if (speed > 0)
+        due += chrono::duration_cast<chrono::steady_clock::duration>(
+                 chrono::duration<double>(s.seconds / speed));
+      while (solving && chrono::steady_clock::now() < due) {
+         if (view != NULL && !view->idle())
+           solving = false;
+         this_thread::sleep_for(min(chrono::steady_clock::duration(chrono::milliseconds(10)),
+                                    due - chrono::steady_clock::now()));
+      }
+      if (!solving)
+        break;
+
+      if (view != NULL) {
+         painter.draw(*view, s.pieces, s.depth);
+         sprintf(textBuffer, "%.1f seconds, %ld nodes.", s.seconds, s.nodes);
+         drawText(textBuffer);
+         if (!view->idle())
+           solving = false;
+      }
+      ++frames;
+   }
+   solving = false;
+   draw();
+   drawText(" ");
+   return frames;
+}
+
+/*
+ * Add blocks described by 'pieces' to the puzzle.  Return false,
+ * leaving the puzzle unchanged, if a block is already in the puzzle or
+ * does not fit.
+ */
+bool puzzle::addPieces(const std::vector<piecePlacement> &pieces) {
+   assert(currentBlock == NO_BLOCK);
+   int added = 0;
+   bool wasSolving = solving;
    solving = true; // so that add/removeBlock() do not draw
-   while (inputSolnFile.peek() != '\n') {
-      inputSolnFile >> bColour >> bOrientation;
-      // find block in queue
-      for (i = 0; i < Q.getCount(); ++i) {
-         pickUpBlock();
-         if (currentBlockPtr->getColour() == bColour)
-           break;
+   for (; added < (int)pieces.size(); ++added) {
+      const piecePlacement &p = pieces[added];
+      if (p.block < 0 || p.block >= numberOfBlocks || p.orientation < 0 || p.orientation > 7
+          || p.anchor < 0 || p.anchor >= height * width)
+        break;
+      blockMask bit = (blockMask)1 << p.block;
+      if (!(waiting & bit))
+        break; // block already in puzzle
+      currentBlock = p.block;
+      waiting     &= ~bit;
+      heldBlock().changeOrientation(p.orientation);
+      pos at;
+      at.r = p.anchor / width;
+      at.c = p.anchor % width;
+      if (!addBlock(at)) {
          putDownBlock();
+         break;
       }
-      currentBlockPtr->changeOrientation(bOrientation);
-      addBlock();
-      ++bCount;
-      // ignore spaces following block data in file
-      inputSolnFile.ignore(2);
    }
-   inputSolnFile.get(); // remove '\n' from input stream
-   draw();
+   bool ok = added == (int)pieces.size();
+   for (int i = 0; i < added && !ok; ++i) {
+      removeBlock();
+      putDownBlock();
+   }
+   solving = wasSolving;
+   return ok;
+}
 
-   sprintf(textBuffer, "Solution %d.", solutionNo);
-   drawText(textBuffer);
+/*
+ * Remove the last 'n' blocks added to the puzzle.
+ */
+void puzzle::removePieces(int n) {
+   assert(currentBlock == NO_BLOCK);
+   bool wasSolving = solving;
+   solving = true; // so that removeBlock() does not draw
+   for (; n > 0 && placedCount > 0; --n) {
+      removeBlock();
+      putDownBlock();
+   }
+   solving = wasSolving;
+}
+
+/*
+ * Set 'pieces' to the blocks in the puzzle.
+ */
+void puzzle::getPieces(std::vector<piecePlacement> &pieces) {
+   pieces.clear();
+   for (int i = 0; i < placedCount; ++i)
+     pieces.push_back(pieceOf(placed[i]));
+}
+
+/*
+ * Give "solve" a cache of 'bytes' bytes replacing entries by 'policy'.
+ */
+void puzzle::setCache(const size_t bytes, const cacheReplacement policy) {
+   if (bytes != cacheBytes || policy != cachePolicy)
+     dropKeptCaches();
+   cacheBytes  = bytes;
+   cachePolicy = policy;
+}
 
-   for (int j = 0; j < bCount; ++j) {
+/*
+ * Keep cache from one "solve" to the next if 'k' is set.
+ */
+void puzzle::setKeepCache(const bool k) {
+   if (!k)
+     dropKeptCaches();
+   keepCache = k;
+}
+
+/*
+ * Read next line of a text solution file from 'in' into 'pieces'.
+ */
+bool puzzle::readTextSolution(istream &in, std::vector<piecePlacement> &pieces) {
+   assert(currentBlock == NO_BLOCK);
+   bool wasSolving = solving;
+   solving = true; // so that add/removeBlock() do not draw
+   int bCount = addTextSolution(in, pieces);
+   for (int i = 0; i < bCount; ++i) {
       removeBlock();
       putDownBlock();
    }
-   solving = false; // allowing add/removeBlock() to draw again
+   solving = wasSolving;
+   return bCount >= 0;
 }
 
 /*
- * Remove all blocks from the puzzle, delete all the blocks,
- * then read a new block set from file "fileName".
+ * Write 'pieces[0..n-1]' to 'out' as a line of a text solution file.
  */
-bool puzzle::readBlockSet(char *fileName) {
-   assert(currentBlockPtr == NULL);
-   ifstream file(fileName, ios::nocreate);
+void puzzle::writeTextSolution(ostream &out, const piecePlacement *pieces, const int n) {
+   for (int i = 0; i < n; ++i)
+     out << blocks[pieces[i].block].getColour() << " " << pieces[i].orientation << "  ";
+   out << '\n'; // not flushed, solution files are written in large blocks
+}
 
-   if (file == NULL)
+/*
+ * Remove all blocks from the puzzle, then replace them with the block
+ * set read from file "fileName" (see "blockset.h").  Return false,
+ * leaving the puzzle unchanged, if it cannot be read.
+ */
+bool puzzle::readBlockSet(const char *fileName) {
+   assert(currentBlock == NO_BLOCK);
+   blockSet newBlocks;
+   if (!readBlockSetFile(fileName, newBlocks, readError))
      return false;
 
-   // remove all blocks from puzzle
-   pos p;
-   for (p.r = 0; p.r < height; ++p.r)
-     for (p.c = 0; p.c < width; ++p.c)
-       if (grid[p.r][p.c] != RGB(0, 0, 0)) {
-          removeBlock(p);
-          putDownBlock();
+   // remove all blocks from puzzle, then replace them
+   removeAllBlocks();
+   solutionsRead.close(); // may be for old block set
+   solutionLines.close();
+   blocks.swap(newBlocks);
+   numberOfBlocks = blocks.size();
+   blocks.buildMasks(width);
+   waiting   = numberOfBlocks == MAX_NUMBER_BLOCKS ? ~(blockMask)0
+                                                   : ((blockMask)1 << numberOfBlocks) - 1;
+   nextBlock = 0;
+   buildPlacementTable();
+   hashBlockSet();
+   readError.clear();
+   return true;
+}
+
+/*
+ * Remove all blocks from the puzzle and make 'b' the puzzle grid.
+ */
+void puzzle::setBoard(const board &b) {
+   assert(currentBlock == NO_BLOCK);
+   removeAllBlocks();
+   solutionsRead.close(); // may be for old board
+   solutionLines.close();
+
+   shape       = b;
+   height      = b.getHeight();
+   width       = b.getWidth();
+   gridWords   = BB_WORDS(height * width) <= INLINE_MASK_WORDS ? BB_WORDS(height * width)
+                                                           : PUZZLE_BITBOARD_WORDS;
+
+   // squares not to be filled are occupied from the start
+   blocked.clear();
+   for (int r = 0; r < height; ++r)
+     for (int c = 0; c < width; ++c)
+       switch (b.getSquare(r, c)) {
+        case OPEN_SQUARE:
+          grid[r][c] = RGB(0, 0, 0);
+          break;
+        case BLOCKED_SQUARE:
+          grid[r][c] = BLOCKED_COLOUR;
+          blocked.set(r * width + c);
+          break;
+        case OUTSIDE_SQUARE:
+          grid[r][c] = OUTSIDE_COLOUR;
+          blocked.set(r * width + c);
+          break;
        }
+   occupied = blocked;
+   foundSolution  = false;
+   nextEmptyPos.r = nextEmptyPos.c = 0;
+   nextEmptyPos   = findNextEmptyPos();
 
-   // delete all blocks
-   while (Q.serve(currentBlockPtr))
-     delete currentBlockPtr;
+   // masks and placements depend on grid
+   blocks.buildMasks(width);
+   buildPlacementTable();
+   hashBlockSet();
 
-   // fill Q with blocks read from file
-   block tempBlock;
-   while (file >> tempBlock) {
-      currentBlockPtr = new block(tempBlock);
-      Q.append(currentBlockPtr);
+   if (view != NULL) {
+      view->setGridSize(height, width);
+      draw();
    }
+}
 
-   currentBlockPtr = NULL;
+/*
+ * Read board from file 'fileName' and make it the puzzle grid.
+ */
+bool puzzle::readBoard(const char *fileName) {
+   ifstream file(fileName);
+   board b;
+   if (!(file >> b))
+     return false;
+   setBoard(b);
    return true;
 }
 
 // PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
 
+/*
+ * Called by the search for each solution found.
+ * Queue blocks placed to be written to solution file.
+ * Return false to halt the search once "solutionLimit" is reached.
+ */
+bool puzzle::solution(const piecePlacement *pieces, const int n) {
+   ++solutionCount;
+   if (!countOnly)
+     output.push(pieces, n); // written on writer thread
+   if (solutionHandler)
+     solutionHandler(pieces, n);
+   if (solutionLimit > 0 && solutionCount >= solutionLimit) {
+      limitReached = true;
+      return false;
+   }
+   return true;
+}
+
+/*
+ * Called by a search counting solutions for 'n' solutions found at once
+ * (counting no more than "solutionLimit" allows, as a search finding them
+ * one at a time would).  Return false to halt the search once
+ * "solutionLimit" is reached.
+ */
+bool puzzle::solutionsCounted(long n) {
+   if (solutionLimit > 0 && solutionCount + n > solutionLimit)
+     n = solutionLimit - solutionCount;
+   solutionCount += n;
+   if (solutionLimit > 0 && solutionCount >= solutionLimit) {
+      limitReached = true;
+      return false;
+   }
+   return true;
+}
+
+/*
+ * Called periodically by the search.
+ * Let the view handle user input so that mouse movement etc. is not
+ * halted while solving and so that user may stop solution process.
+ * Return false if solution process should be halted.
+ */
+bool puzzle::poll(double percent, const long nodes) {
+   if (view != NULL && !view->idle())
+     solving = false; // application closing
+   if ((cancelFlag != NULL && *cancelFlag) || chrono::steady_clock::now() >= deadline)
+     solving = false;
+
+   // measure progress by nodes searched out of estimated total if possible
+   if (refineEstimate) {
+      estimatedNodes = refineEstimate(ESTIMATE_PROBES_PER_POLL);
+      percent = nodes < estimatedNodes ? 100 * nodes / estimatedNodes : 99.9;
+   }
+
+   // update message when percentage has changed
+   if ((int)(percent * 10) != (int)(percentSolved * 10)) {
+      double elapsed = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+      if (refineEstimate && percent > 0)
+        sprintf(textBuffer, "%2.1f%% complete, about %.0f seconds left.",
+                percent, elapsed * (100 - percent) / percent);
+      else
+        sprintf(textBuffer, "%2.1f%% complete.", percent);
+      drawText(textBuffer);
+   }
+   percentSolved = percent;
+
+   return solving;
+}
+
+/*
+ * Search for all solutions from current state of puzzle grid using
+ * placement table 't' and the selected engine, publishing snapshots to
+ * "watcher" if 'watched'.
+ * Return true if all solutions were found.
+ */
+template <int WORDS>
+bool puzzle::runSearch(const placementTable<WORDS> &fullTable, const blockMask usedBlocks,
+                       const bool watched) {
+   bitboard<WORDS> start;
+   bool finished;
+   start.copyFrom(occupied);
+
+   // search restricted table if board symmetry can be broken
+   symmetryBreaker<WORDS> sym(fullTable, height, width, *this, expandSymmetry && !countOnly);
+   const placementTable<WORDS> *t = &fullTable;
+   searchObserver *o = this;
+   symmetryCount = 1;
+   if (breakSymmetry && sym.prepare(start, usedBlocks)) {
+      t = &sym.getTable();
+      o = &sym;
+      if (!expandSymmetry || countOnly)
+        symmetryCount = sym.getSymmetryCount();
+   }
+
+   // estimate size of backtracking search tree, refined by "poll"
+   treeEstimator<WORDS> estimator(*t, start, usedBlocks);
+   estimatedNodes = 0;
+   refineEstimate = nullptr;
+   if (engine == BACKTRACKING_ENGINE && estimateProgress) {
+      estimatedNodes = estimator.probe(ESTIMATE_PROBES);
+      refineEstimate = bind(&treeEstimator<WORDS>::probe, &estimator, placeholders::_1);
+   }
+
+   if (engine == EXACT_COVER_ENGINE) {
+      dlx d(*o);
+      d.build(*t, start, usedBlocks);
+      finished = d.run();
+      percentSolved = d.getPercentSolved();
+      nodeCount     = d.getNodeCount();
+      testedCount   = d.getTestedCount();
+      stats         = searchStats(); // not collected by exact cover engine
+   }
+   else if (threads > 1) {
+      parallelSearch<WORDS> s(*t, *o, threads, splitDepth);
+      s.setPruning(pruning);
+      s.setCountOnly(countOnly && !solutionHandler, solutionLimit); // nothing needs each solution
+      finished = s.run(start, usedBlocks);
+      percentSolved = s.getPercentSolved();
+      prunedCount   = s.getPrunedCount();
+      nodeCount     = s.getNodeCount();
+      testedCount   = s.getTestedCount();
+      stats         = s.getStats();
+   }
+   else {
+      // cache kept from earlier solves if wanted and valid for table searched
+      backtrackSearch<WORDS> s(*t, *o);
+      bool keep = keepCache && t == &fullTable;
+      transpositionCache<WORDS> local(keep ? 0 : cacheBytes, cachePolicy);
+      transpositionCache<WORDS> *cache = &local;
+      if (keep) {
+         std::unique_ptr<transpositionCache<WORDS> > &kept = keptCache(fullTable);
+         if (!kept)
+           kept.reset(new transpositionCache<WORDS>(cacheBytes, cachePolicy));
+         cache = kept.get();
+      }
+      cacheStats before = cache->getStats();
+      s.setPruning(pruning);
+      if (cacheBytes > 0)
+        s.setCache(cache, countOnly);
+      if (watched)
+        s.setMailbox(&watcher->getMailbox());
+      finished = s.run(start, usedBlocks);
+      cacheCounts            = cache->getStats();
+      cacheCounts.hits      -= before.hits;
+      cacheCounts.misses    -= before.misses;
+      cacheCounts.stores    -= before.stores;
+      cacheCounts.evictions -= before.evictions;
+      cacheCounts.dropped   -= before.dropped;
+      percentSolved = s.getPercentSolved();
+      prunedCount   = s.getPrunedCount();
+      nodeCount     = s.getNodeCount();
+      testedCount   = s.getTestedCount();
+      stats         = s.getStats();
+   }
+   refineEstimate = nullptr;
+   if (!finished && estimatedNodes > 0)
+     percentSolved = nodeCount < estimatedNodes ? 100 * nodeCount / estimatedNodes : 99.9;
+   return finished;
+}
+
+/*
+ * Estimate search of "runSearch" from current state ('probes' random paths).
+ */
+template <int WORDS>
+void puzzle::estimateSearch(const placementTable<WORDS> &fullTable, const blockMask usedBlocks,
+                            const int probes, double &nodes, double &solutions, double &seconds) {
+   bitboard<WORDS> start;
+   start.copyFrom(occupied);
+
+   // same table as "runSearch" searches
+   symmetryBreaker<WORDS> sym(fullTable, height, width, *this, false);
+   const placementTable<WORDS> *t = &fullTable;
+   if (breakSymmetry && sym.prepare(start, usedBlocks))
+     t = &sym.getTable();
+
+   treeEstimator<WORDS> estimator(*t, start, usedBlocks);
+   nodes     = estimator.probe(probes);
+   solutions = estimator.getSolutions();
+   seconds   = estimator.getNodesPerSecond() > 0 ? nodes / estimator.getNodesPerSecond() : 0;
+   int hardware = workStealingPool::hardwareThreads();
+   seconds /= threads < hardware ? threads : hardware;
+}
+
+/*
+ * Set "blockHash" (see "blockSetHash" in "solfile.h").  If the board
+ * has blocked squares they are hashed too, so that solution files for
+ * other boards of the same size are not read by mistake.
+ */
+void puzzle::hashBlockSet(void) {
+   blockHash = blockSetHash(blocks.data(), numberOfBlocks);
+   if (!blocked.empty())
+     for (int i = 0; i < BB_WORDS(height * width); ++i)
+       blockHash = (blockHash ^ blocked.word(i)) * 1099511628211ULL;
+}
+
+/*
+ * Enumerate every placement of every block for the current grid size,
+ * in the table searched for grids of this size (see "gridWords").  The
+ * other tables are emptied.
+ */
+void puzzle::buildPlacementTable(void) {
+   dropKeptCaches(); // hold results for old placements
+   smallTable.clear();
+   mediumTable.clear();
+   largeTable.clear();
+   if (gridWords == 1) {
+      bitboard<1> b;
+      b.copyFrom(blocked);
+      smallTable.build(blocks.data(), numberOfBlocks, height, width, &b);
+   }
+   else if (gridWords == 2) {
+      bitboard<2> b;
+      b.copyFrom(blocked);
+      mediumTable.build(blocks.data(), numberOfBlocks, height, width, &b);
+   }
+   else
+     largeTable.build(blocks.data(), numberOfBlocks, height, width, &blocked);
+}
+
+/*
+ * Free caches kept between solves (see "setKeepCache").
+ */
+void puzzle::dropKeptCaches(void) {
+   smallCache.reset();
+   mediumCache.reset();
+   largeCache.reset();
+}
+
 /*
  * Test whether "currentBlock" fits in puzzle grid with blocks TL
  * square on 'p'.  Return true if does, false otherwise.
@@ -409,27 +1016,30 @@ bool puzzle::readBlockSet(char *fileName) {
 bool puzzle::blockFits(const pos p) {
    assert(p.r >= 0 && p.r < height && p.c >= 0 && p.c < width);
    // superimpose block over grid with TL on p.  Check whether any
-   // part of block now lies outside grid boundary or is in position
-   // already occupied.
-   int blockH    = currentBlockPtr->getHeight(),
-       blockW    = currentBlockPtr->getWidth(),
-       TLcol     = currentBlockPtr->getTLcol(),
-       rowOffset = p.r,
-       colOffset = p.c - TLcol,
-       r, c;
-   for (r = 0; r < blockH; ++r)
-     for (c = 0; c < blockW; ++c)
-       if (currentBlockPtr->getGrid(r, c)
-           && (//    left overlaps
-                  (c < TLcol && (c + colOffset) < 0)
-               // OR right overlaps
-               || (c > TLcol && (c + colOffset) > width - 1)
-	            // OR bottom overlaps (no need to check top overlap)
-               || (r > 0 && (r + rowOffset) > height - 1)
-	            // OR position already occupied
-               || (grid[r + rowOffset][c + colOffset] != RGB(0, 0, 0))))
-	      return false;
-   return true;
+   // part of block now lies outside grid boundary (no need to check
+   // top overlap) or is in position already occupied.
+   int colOffset = p.c - heldBlock().getTLcol();
+   if (   colOffset + heldBlock().getMaskLeft()  < 0
+       || colOffset + heldBlock().getMaskRight() > width - 1
+       || p.r + heldBlock().getMaskBottom()      > height - 1)
+     return false;
+
+   int shift = maskShift(p);
+   if (gridWords == 1)
+     return !(occupied.word(0) & (heldBlock().getMask()[0] << shift));
+
+   puzzleBitboard m;
+   m.loadShifted(heldBlock().getMask(), heldBlock().getMaskWords(), shift);
+   return !occupied.intersects(m);
+}
+
+/*
+ * Return the distance "currentBlock"s mask must be shifted to
+ * superimpose it on the puzzle grid with blocks TL square on 'p'.
+ */
+inline int puzzle::maskShift(const pos p) {
+   return p.r * width + p.c - heldBlock().getTLcol()
+          + heldBlock().getMaskLeft();
 }
 
 /*
@@ -437,19 +1047,22 @@ bool puzzle::blockFits(const pos p) {
  * block grid, occupied or unoccupied. ie not TL.
  */
 void puzzle::drawBlock(pos p, COLORREF colour) {
-   int blockH = currentBlockPtr->getHeight(),
-       blockW = currentBlockPtr->getWidth(),
+   int blockH = heldBlock().getHeight(),
+       blockW = heldBlock().getWidth(),
        r, c;
+   beginDraw();
    for (r = 0; r < blockH; ++r)
      for (c = 0; c < blockW; ++c) {
-        if (currentBlockPtr->getGrid(r, c)
-            && p.r + r < height && p.c + c < width)
-          if (colour != RGB(0, 0, 0))
-            drawSquare(colour, p.r + r, p.c + c);
-          else // colour = black (erase)
-            // draw square with colour stored in grid
-            drawSquare(grid[p.r + r][p.c + c], p.r + r, p.c + c);
+        if (heldBlock().getGrid(r, c)
+            && p.r + r < height && p.c + c < width) {
+           if (colour != RGB(0, 0, 0))
+             drawSquare(colour, p.r + r, p.c + c);
+           else // colour = black (erase)
+             // draw square with colour stored in grid
+             drawSquare(grid[p.r + r][p.c + c], p.r + r, p.c + c);
+        }
      }
+   endDraw();
 }
 
 /*
@@ -458,26 +1071,40 @@ void puzzle::drawBlock(pos p, COLORREF colour) {
  * erase "currentBlock" from screen and update "nextEmptyPos".
  */
 void puzzle::updateGrid(void) {
-   COLORREF colour  = currentBlockPtr->getColour();
-   int startR  = currentBlockPtr->getPuzPos().r,
-       startC  = currentBlockPtr->getPuzPos().c - currentBlockPtr->getTLcol(),
-       finishR = startR + currentBlockPtr->getHeight(),
-       finishC = startC + currentBlockPtr->getWidth(),
+   // remove block from occupied squares
+   int shift = maskShift(heldBlock().getPuzPos());
+   if (gridWords == 1)
+     occupied.word(0) ^= heldBlock().getMask()[0] << shift;
+   else {
+      puzzleBitboard m;
+      m.loadShifted(heldBlock().getMask(), heldBlock().getMaskWords(), shift);
+      occupied ^= m;
+   }
+
+   COLORREF colour  = heldBlock().getColour();
+   int startR  = heldBlock().getPuzPos().r,
+       startC  = heldBlock().getPuzPos().c - heldBlock().getTLcol(),
+       finishR = startR + heldBlock().getHeight(),
+       finishC = startC + heldBlock().getWidth(),
        r, c;
 
    // remove block of specific colour from grid
+   if (!solving)
+     beginDraw();
    for (r = startR; r < finishR; ++r)
      for (c = startC; c < finishC; ++c)
-       if (grid[r][c] == colour) {
+       if (grid[r][c] == colour && !blocked.test(r * width + c)) {
           grid[r][c] = RGB(0, 0, 0);
           if (!solving)
             drawSquare(grid[r][c], r, c);
        }
+   if (!solving)
+     endDraw();
 
    // update nextEmptyPos
    if (solving) {
-      nextEmptyPos.r = currentBlockPtr->getPuzPos().r;
-      nextEmptyPos.c = currentBlockPtr->getPuzPos().c;
+      nextEmptyPos.r = heldBlock().getPuzPos().r;
+      nextEmptyPos.c = heldBlock().getPuzPos().c;
    }
    else {
       // reset so searches from r = c = 0
@@ -495,94 +1122,126 @@ void puzzle::updateGrid(void) {
  */
 pos puzzle::findNextEmptyPos(void) {
    pos p;
-   p.c = nextEmptyPos.c;
-   for (p.r = nextEmptyPos.r; p.r < height; ++p.r) {
-      for (; p.c < width; ++p.c)
-        if (grid[p.r][p.c] == RGB(0, 0, 0))
-          return p;
-      p.c = 0;
+   int cells = height * width,
+       i     = occupied.firstClear(nextEmptyPos.r * width + nextEmptyPos.c, cells);
+   if (i < cells) {
+      p.r = i / width;
+      p.c = i % width;
+      return p;
    }
+   p.r = height;
+   p.c = 0;
    foundSolution = true;
    return p;
 }
 
 /*
- * Slave function for "int solve(void)".
+ * Set 'colours' to colour of each square of puzzle grid, row by row.
  */
-bool puzzle::solveRecursively(ofstream file) {
-   assert(currentBlockPtr == NULL);
+void puzzle::getGridColours(vector<COLORREF> &colours) {
+   colours.resize(height * width);
+   for (int r = 0; r < height; ++r)
+     for (int c = 0; c < width; ++c)
+       colours[r * width + c] = grid[r][c];
+}
 
-   // handle Windows OS messages so that mouse movement etc. is not
-   // halted while solving and so that user may stop solution process
-   MSG msg;
-   if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
-      if (msg.message == WM_QUIT)
-         solving = false;
-   	TranslateMessage(&msg); // translate any accelerator keys
-		DispatchMessage(&msg); // send the message to the window proc
-   }
-   if (!solving)
-     return false;
+/*
+ * Draw square to screen at 'p' in colour 'c'.
+ */
+void puzzle::drawSquare(const COLORREF colour, int r, int c) {
+   if (view != NULL && r >= 0 && r < height && c >= 0 && c < width)
+     view->drawSquare(colour, r, c);
+}
 
-   int QCount = Q.getCount(),
-       i, j;
-   for (i = 0; i < QCount; ++i) { // for each block left in queue
-      pickUpBlock();
-      for (j = 0; j < 8; ++j) { // for each possible block orientation
-
-         // update message each time the stack is emptied (puzzle cleared)
-         if (S.empty()) {
-            sprintf(textBuffer, "%2.1f%% complete.",
-                    percentSolved);
-            drawText(textBuffer);
-            percentSolved += 100 / (float)(QCount * 8);
+/*
+ * Read a line of a text solution file from 'in' and add the blocks it
+ * describes to the puzzle, each at the next empty position.  Blocks
+ * are identified by colour; where several have the same colour the
+ * first that fits is used.  Return number of blocks added and their
+ * placements in 'pieces', or -1 (leaving puzzle unchanged) if the line
+ * is missing or does not describe blocks that fit.
+ * For use while "solving" (nothing is drawn).
+ */
+int puzzle::addTextSolution(istream &in, std::vector<piecePlacement> &pieces) {
+   int bCount = 0, bOrientation, ch, i;
+   COLORREF bColour;
+   bool ok = true;
+
+   pieces.clear();
+   if (in.peek() == EOF)
+     return -1;
+   while (ok && (ch = in.peek()) != '\n' && ch != EOF) {
+      if (ch == ' ' || ch == '\r') {
+         in.get(); // spaces following block data, Windows line ending
+         continue;
+      }
+      if (!(in >> bColour >> bOrientation) || bOrientation < 0 || bOrientation > 7) {
+         ok = false;
+         break;
+      }
+      // find first block of colour not in puzzle that fits
+      ok = false;
+      for (blockMask left = waiting; left != 0 && !ok; left &= left - 1) {
+         i = lowestBit(left);
+         if (blocks[i].getColour() == bColour && nextEmptyPos.r < height) {
+            currentBlock = i;
+            waiting     &= ~((blockMask)1 << i);
+            heldBlock().changeOrientation(bOrientation);
+            ok = addBlock();
+            if (!ok)
+              putDownBlock();
          }
+      }
+      if (ok) {
+         pieces.push_back(pieceOf(placed[placedCount - 1]));
+         ++bCount;
+      }
+   }
+   in.get(); // remove '\n' from input stream
 
-         if (blockOrientUnique(j)) {
-            reorientBlock(j);
-            if (addBlock()) {
-               // NOTE: must add this feature to pull down menu
-               //if (animateSolnProcess) {
-               //   draw();
-               //   delay(100);
-               //}
-
-               if (foundSolution) {
-                  ++solutionCount;
-                  file << S;
-               }
-               if (!solveRecursively(file)) // recursive call
-                 // solution process has been halted early
-                 return false;
-               removeBlock();
-            }
-         }
+   if (!ok) {
+      for (i = 0; i < bCount; ++i) {
+         removeBlock();
+         putDownBlock();
       }
-      putDownBlock();
+      pieces.clear();
+      return -1;
    }
-   return true;
+   return bCount;
 }
 
 /*
- * Draw square to screen at 'p' in colour 'c'.
+ * Open solution file for "viewSolution" (unless already open) as
+ * binary or text file as appropriate.  Return false if it cannot be read.
  */
-void puzzle::drawSquare(const COLORREF colour, int r, int c) {
-   if (r >= 0 && r < height && c >= 0 && c < width) {
-      HDC hdc = GetDC(main_window_handle);
-
-      HPEN pen = CreatePen(PS_SOLID, 0, colour);
-      HPEN old_pen = (HPEN)SelectObject(hdc, pen);
+bool puzzle::openSolutionFile(void) {
+   if (solutionsRead.isOpen() || solutionLines.isOpen())
+     return true;
+   if (isBinarySolutionFile(solutionFileName.c_str()))
+     return solutionsRead.open(solutionFileName.c_str());
+   return solutionLines.open(solutionFileName.c_str());
+}
 
-      HBRUSH brush = CreateSolidBrush(colour);
-      HBRUSH old_brush = (HBRUSH)SelectObject(hdc, brush);
+/*
+ * Return placement of block 'b' in puzzle grid.
+ */
+piecePlacement puzzle::pieceOf(const int b) {
+   piecePlacement p;
+   p.block       = b;
+   p.orientation = blocks[b].getOrientation();
+   p.anchor      = blocks[b].getPuzPos().r * width + blocks[b].getPuzPos().c;
+   return p;
+}
 
-      Rectangle(hdc, c * SQUARE_SIZE, r * SQUARE_SIZE,
-               (c + 1) * SQUARE_SIZE, (r + 1) * SQUARE_SIZE);
-   
-      SelectObject(hdc, old_pen);
-      SelectObject(hdc, old_brush);
-      DeleteObject(pen);
-      DeleteObject(brush);
-      ReleaseDC(main_window_handle, hdc);
-   }
+/*
+ * Remove all blocks from the puzzle grid, leaving none held.
+ */
+void puzzle::removeAllBlocks(void) {
+   pos p;
+   for (p.r = 0; p.r < height; ++p.r)
+     for (p.c = 0; p.c < width; ++p.c)
+       if (grid[p.r][p.c] != RGB(0, 0, 0) && !blocked.test(p.r * width + p.c)) {
+          removeBlock(p);
+          putDownBlock();
+       }
 }
\ No newline at end of file
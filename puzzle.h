@@ -6,36 +6,268 @@
 *                                                                                                 *
 \*************************************************************************************************/
 
-#ifndef PUZZLE_H
-#define PUZZLE_H
+#ifndef PUZZLE_H
+#define PUZZLE_H
 
 #include <stdio.h>
 #include <math.h>
 #include <assert.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <atomic>
+#include <functional>
 
-#include "block.h"
-#include "stack.h"
-#include "queue.h"
+#include "bitboard.h"
+#include "block.h"
+#include "board.h"
+#include "view.h"
+#include "search.h"
+#include "dlx.h"
+#include "parallel.h"
+#include "symmetry.h"
+#include "solfile.h"
+#include "solqueue.h"
+#include "estimate.h"
+#include "blockset.h"
+#include "watch.h"
 
-#define MAX_PUZZLE_HEIGHT 25
-#define MAX_PUZZLE_WIDTH  25
-#define MAX_NUMBER_BLOCKS 15
-#define SQUARE_SIZE       25
+#define BLOCKED_COLOUR        RGB(96, 96, 96)   // blocked squares of board (see "board.h")
+#define OUTSIDE_COLOUR        RGB(200, 200, 200) // squares outside board
+#define NO_BLOCK              (-1)              // "currentBlock" when no block is held
+#define DEFAULT_SPLIT_DEPTH   2              // depth at which parallel solve splits search into tasks
+#define DEFAULT_SOLUTION_FILE "solution.dat" // file written by "solve" and read by "viewSolution"
 
-extern HWND main_window_handle;
-
-class puzzle {
- public:
+/*
+ * Search algorithms available to "puzzle::solve".
+ */
+enum solverEngine {BACKTRACKING_ENGINE, EXACT_COVER_ENGINE};
+
+/*
+ * Solution file formats written by "puzzle::solve" (see "solfile.h"
+ * for the binary format).  Text files hold one line per solution
+ * listing the colour and orientation of each block placed.
+ */
+enum solutionFormat {TEXT_SOLUTIONS, BINARY_SOLUTIONS};
+
+class puzzle : private searchObserver {
+ public:
    puzzle(void);
    ~puzzle(void);
 
    int getWidth(void)         {return width;        }
    int getHeight(void)        {return height;       }
    int getSolutionCount(void) {return solutionCount;}
+   int getBlockCount(void)    {return numberOfBlocks;}
 
    void stopSolving(void)     {solving = false;}
 
-   bool holdingBlock(void)    {return currentBlockPtr != NULL;}
+   /*
+    * Make "solve" stop, as "stopSolving" does, once 'deadline' has
+    * passed (time_point::max() for none, the default), or once '*flag'
+    * is set by any thread (NULL for no flag).  The search checks both
+    * every SEARCH_POLL_INTERVAL nodes.
+    */
+   void setDeadline(std::chrono::steady_clock::time_point t) {deadline = t;  }
+   void setCancelFlag(const std::atomic<bool> *flag)         {cancelFlag = flag;}
+
+   /*
+    * Attach user interface 'v' (see "view.h"), or detach it if NULL.
+    * Without a view the puzzle draws nothing and "solve" can only be
+    * halted by "stopSolving", a deadline or a cancel flag.
+    */
+   void setView(puzzleView *v);
+
+   /*
+    * Set name of file written by "solve" and read by "viewSolution".
+    */
+   void setSolutionFile(const char *fileName) {
+      solutionsRead.close();
+      solutionLines.close();
+      solutionFileName = fileName;
+   }
+
+   /*
+    * Select format of file written by "solve" (binary by default).
+    * "viewSolution" reads either.
+    */
+   void setSolutionFormat(solutionFormat f) {format = f;   }
+   solutionFormat getSolutionFormat(void)   {return format;}
+
+   /*
+    * Return hash of block set (see "blockSetHash" in "solfile.h").
+    */
+   unsigned long long getBlockSetHash(void) {return blockHash;}
+
+   /*
+    * Return report of last "solve" (solutions found, time taken etc.),
+    * and time it took in seconds.
+    */
+   const char *getReport(void)    {return report;   }
+   double      getTimeTaken(void) {return timeTaken;}
+
+   /*
+    * Return number of nodes visited and placements tested for fit
+    * by the search during the last "solve".
+    */
+   long getNodeCount(void)        {return nodeCount;  }
+   long getTestedCount(void)      {return testedCount;}
+
+   /*
+    * Return whether the last "solve" found every solution (was not
+    * stopped by the user or a solution limit).
+    */
+   bool getCompleted(void)        {return completed;  }
+
+   /*
+    * Return number of placements of blocks in the empty grid (see
+    * "placementTable"), and the memory they take in bytes.
+    */
+   int    getPlacementCount(void);
+   size_t getPlacementBytes(void);
+
+   /*
+    * Return search statistics of the last "solve" (backtracking engine
+    * only, and only if compiled with SEARCH_STATS, see "stats.h").
+    */
+   const searchStats &getStats(void) {return stats;}
+
+   /*
+    * Select search algorithm used by "solve".  Both find the same
+    * solutions and write the same lines to the solution file, but not
+    * in the same order (see "dlx.h").
+    */
+   void setEngine(solverEngine e) {engine = e;   }
+   solverEngine getEngine(void)   {return engine;}
+
+   /*
+    * Set number of threads used by "solve" (backtracking engine only)
+    * and the number of blocks placed before the search is split into
+    * tasks shared between them.  Solutions are written in the same
+    * order whatever the number of threads.
+    */
+   void setThreads(int n)        {threads = n > 0 ? n : 1;}
+   void setSplitDepth(int d)     {splitDepth = d;         }
+   int  getThreads(void)         {return threads;         }
+   int  getSplitDepth(void)      {return splitDepth;      }
+
+   /*
+    * If 'b' is set, "solve" finds only one of each set of solutions
+    * that are rotations/reflections of each other (see "symmetry.h"),
+    * and if 'e' is also set, writes each one followed by its symmetric
+    * images so that the solution file holds every solution as usual.
+    */
+   void setBreakSymmetry(bool b)  {breakSymmetry = b;   }
+   void setExpandSymmetry(bool e) {expandSymmetry = e;  }
+   bool getBreakSymmetry(void)    {return breakSymmetry; }
+   bool getExpandSymmetry(void)   {return expandSymmetry;}
+
+   /*
+    * Return number of solutions each solution found by the last
+    * "solve" stands for (1 unless symmetric solutions were skipped).
+    */
+   int  getSymmetryCount(void)    {return symmetryCount; }
+
+   /*
+    * Turn dead region pruning (see "search.h") on or off for "solve"
+    * (backtracking engine only), and return the number of placements
+    * it abandoned during the last solve.
+    */
+   void setPruning(bool p)        {pruning = p;          }
+   bool getPruning(void)          {return pruning;       }
+   long getPrunedCount(void)      {return prunedCount;   }
+
+   /*
+    * Estimate the search "solve" would make from the puzzles current
+    * state by following 'probes' random paths down the search tree (see
+    * "estimate.h").  Set 'nodes' and 'solutions' to the estimated number
+    * of search nodes and solutions, and 'seconds' to the estimated time
+    * taken by the backtracking engine with the current options.
+    */
+   void estimate(int probes, double &nodes, double &solutions, double &seconds);
+
+   /*
+    * During and after "solve" (backtracking engine only), return the
+    * estimated number of nodes in the search tree, refined as the
+    * search goes on; progress is reported as the proportion of these
+    * searched so far.  0 if there is no estimate.
+    */
+   double getEstimatedNodes(void) {return estimatedNodes;}
+
+   /*
+    * Estimate the size of the search before each backtracking "solve"
+    * (ESTIMATE_PROBES random paths) and refine it as it goes, so that
+    * progress and time remaining can be shown (default off: nothing is
+    * spent on it when no one is watching).
+    */
+   void setEstimateProgress(bool e) {estimateProgress = e;   }
+   bool getEstimateProgress(void)   {return estimateProgress;}
+
+   /*
+    * Make "solve" stop once 'n' solutions have been found (0 = find
+    * all), eg. 1 to test whether the puzzle can be solved.
+    */
+   void setSolutionLimit(long n)  {solutionLimit = n > 0 ? n : 0;}
+   long getSolutionLimit(void)    {return solutionLimit;          }
+
+   /*
+    * If 'c' is set, "solve" only counts solutions: nothing is passed
+    * to the writer thread and the solution file is left as it was.
+    */
+   void setCountOnly(bool c)      {countOnly = c;        }
+   bool getCountOnly(void)        {return countOnly;     }
+
+   /*
+    * Have "solve" call 'f' (on the solving thread) with the blocks the
+    * search placed in each solution found, not counting those in the
+    * puzzle beforehand, whether or not solutions are being saved.
+    * Solutions counted without being found (see "setCache") are not
+    * passed.  An empty function for none.
+    */
+   void setSolutionHandler(const std::function<void(const piecePlacement *, int)> &f) {
+      solutionHandler = f;
+   }
+
+   /*
+    * Have "solve" publish snapshots of its search to 'w' (NULL for
+    * none), which draws them on its own view and thread (see
+    * "searchWatcher"), and records them if it has a trace file.  Its
+    * view must not be the puzzle's.  Only the single threaded
+    * backtracking engine is watched; other solves are not.
+    */
+   void setWatcher(searchWatcher *w) {watcher = w;}
+
+   /*
+    * Give "solve" a cache of 'bytes' bytes holding the results of
+    * searches below states already met, replacing entries by 'policy'
+    * (see "cache.h"), or no cache if 'bytes' is 0.  Used by the single
+    * threaded backtracking engine only.  States found to have no
+    * solutions are never searched again; when only counting (see
+    * "setCountOnly") nor are those with solutions.
+    */
+   void setCache(size_t bytes, cacheReplacement policy);
+   size_t getCacheSize(void)          {return cacheBytes;}
+   cacheReplacement getCachePolicy(void) {return cachePolicy;}
+
+   /*
+    * If 'k' is set the cache is kept from one "solve" to the next
+    * rather than emptied, so that states searched by an earlier solve
+    * (eg. with a block more or less in the grid) are not searched again.
+    * It is emptied when the block set, board or cache size changes, and
+    * not used while symmetry is broken (the search then covers only part
+    * of each state).
+    */
+   void setKeepCache(bool k);
+   bool getKeepCache(void)        {return keepCache;     }
+
+   /*
+    * Return cache hit/miss counts of the last "solve".
+    */
+   const cacheStats &getCacheStats(void) {return cacheCounts;}
+
+   bool holdingBlock(void)    {return currentBlock != NO_BLOCK;}
    
    /*
     * Test whether puzzle is currently solved.
@@ -44,26 +276,26 @@ class puzzle {
    bool solved(void) {return foundSolution;}
 
    /*
-    * Serve block from 'Q' and set as "currentBlock".
-    * Return true if successful, false otherwise.
+    * Take the next block not in the puzzle grid (in block set order,
+    * starting after the one last taken) as "currentBlock".
     */
    void pickUpBlock(void);
 
    /*
-    * Append "currentBlock" to 'Q' and set "currentBlockPtr" to NULL.
-    * Return true if successful, false otherwise.
+    * Return "currentBlock" to the blocks not in the puzzle grid, leaving
+    * no block held.
     */
    void putDownBlock(void);
 
    /*
     * Rotate "currentBlock" 90 degrees clockwise.
     */
-   void rotateBlock(void) {currentBlockPtr->rotate();}
+   void rotateBlock(void) {heldBlock().rotate();}
 
    /*
     * Flip "currentBlock" vertically.
     */
-   void flipBlock(void) {currentBlockPtr->flip();}
+   void flipBlock(void) {heldBlock().flip();}
 
    /*
     * Change "currentBlock" orientation.
@@ -100,7 +332,7 @@ class puzzle {
     * 'p' here is position in grid of "holdPos" of block.
     */
    void eraseBlock(pos);
-
+
    /*
     * Attempt to add "currentBlock" to puzzle at first available
     * position (looking at grid from left->right & top->bottom).
@@ -112,7 +344,7 @@ class puzzle {
     * Attempt to add "currentBlock" to puzzle at position 'p'.
     * Return true if successful, else false.
     */
-   bool addBlock(pos p);
+   bool addBlock(pos p);
    
    /*
     * Remove last block added to puzzle (of those remaining) and
@@ -130,66 +362,230 @@ class puzzle {
    bool removeBlock(pos p);
 
    /*
-    * Print puzzle grid to screen as text.
+    * Print puzzle grid to 'out' as text, one letter per block
+    * ('A' = first block in block set) and '-' for empty squares.
     */
-   void print(void);
+   void print(std::ostream &out);
 
    /*
     * Print current block to screen as text.
     */
-   void printBlock(void) {currentBlockPtr->print();}
+   void printBlock(void) {heldBlock().print();}
 
    /*
     * Draw puzzle.
     */
    void draw(void);
 
+   /*
+    * Start and end a run of drawing to be shown at once, eg. "eraseBlock"
+    * then "drawBlock" with the block moved, rotated or flipped in
+    * between, so that the view shows only the squares that changed (see
+    * "puzzleView::beginDraw").  Runs may be nested.
+    */
+   void beginDraw(void);
+   void endDraw(void);
+
    /*
     * Draw text in text area of main window.
     * If empty string is supplied will redraw most recent message.
     */
-   void drawText(char *);
+   void drawText(const char *);
 
    /*
     * Find all solutions of the puzzle from the puzzles current
-    * state.  Return the number of solutions found.
+    * state and write them to the solution file (see "setSolutionFile").
+    * Return the number of solutions found, or -1 if the solution file
+    * could not be opened.  See also "setSolutionLimit" and "setCountOnly".
     */
    int solve(void);
 
    /*
-    * Read the "solutionNo"th solution from the file "solution.dat",
+    * Read the "solutionNo"th solution from the solution file,
     * add blocks to the puzzle in the way described,
     * then draw the solved puzzle.
+    * Blocks are removed again afterwards unless 'keep' is set.
+    * Return false if the solution cannot be read, or the file was
+    * written for another block set or grid.
+    */
+   bool viewSolution(int, bool keep = false);
+
+   /*
+    * Return number of solutions in the solution file, or -1 if it
+    * cannot be read.  Together with "viewSolution" this lets solutions
+    * be viewed in any order; each takes constant time, whatever the
+    * size of the file (see "solutionReader" and "textSolutionIndex").
+    */
+   long long countSolutions(void);
+
+   /*
+    * Draw again the snapshots in trace file 'fileName' (see "watch.h")
+    * of a search of this block set and board, 'speed' times as fast as
+    * they were recorded (0 = as fast as they can be drawn), until
+    * "stopSolving" is called or the view's "idle" returns false.  The
+    * puzzle is left in the state the search started from.  Return the
+    * number of snapshots drawn, or -1 if the file cannot be read, or
+    * was written for another block set, board or state.
     */
-   void viewSolution(int);
+   long replayTrace(const char *fileName, double speed);
 
    /*
-    * Remove all blocks from the puzzle, delete all the blocks,
-    * then read a new block set from file "fileName".
+    * Add blocks described by 'pieces' (block index, orientation and
+    * anchor square) to the puzzle.  Return false, leaving the puzzle
+    * unchanged, if a block is already in the puzzle or does not fit.
     */
-   bool readBlockSet(char *filename);
-
- private:
+   bool addPieces(const std::vector<piecePlacement> &pieces);
+
+   /*
+    * Remove the last 'n' blocks added to the puzzle (eg. by "addPieces").
+    */
+   void removePieces(int n);
+
+   /*
+    * Set 'pieces' to the blocks in the puzzle, in the order added.
+    */
+   void getPieces(std::vector<piecePlacement> &pieces);
+
+   /*
+    * Read the next line of a text solution file from 'in' and return
+    * the blocks it describes in 'pieces' (found by adding them to the
+    * puzzle as "viewSolution" does, then removing them again).
+    * Return false at end of file or if the line does not describe
+    * blocks that fit.
+    */
+   bool readTextSolution(std::istream &in, std::vector<piecePlacement> &pieces);
+
+   /*
+    * Write 'pieces[0..n-1]' to 'out' as a line of a text solution file.
+    */
+   void writeTextSolution(std::ostream &out, const piecePlacement *pieces, int n);
+
+   /*
+    * Remove all blocks from the puzzle, then replace them with the block
+    * set read from file "fileName" (see "blockset.h").  Return false,
+    * leaving the puzzle unchanged, if the file cannot be read or has a
+    * mistake in it (see "getReadError").
+    */
+   bool readBlockSet(const char *filename);
+
+   /*
+    * Return why the last "readBlockSet" failed, as
+    * "file:line:column: what is wrong" (empty if it did not).
+    */
+   const std::string &getReadError(void) const {return readError;}
+
+   /*
+    * Remove all blocks from the puzzle and make 'b' the puzzle grid.
+    * Its blocked squares and squares outside it are marked occupied
+    * and no placement covering them is ever tried, so they add
+    * nothing to the cost of "solve".
+    */
+   void setBoard(const board &b);
+   const board &getBoard(void) {return shape;}
+
+   /*
+    * Read board from file 'fileName' (see "board.h") and make it the
+    * puzzle grid.  Return false, leaving the puzzle unchanged, if the
+    * file cannot be read or does not describe a board.
+    */
+   bool readBoard(const char *fileName);
+
+ private:
+   // searchObserver functions (called by "solve")
+   bool solution(const piecePlacement *pieces, int n);
+   bool solutionsCounted(long n);
+   bool poll(double percent, long nodes);
+
+   template <int WORDS>
+   bool runSearch(const placementTable<WORDS> &, blockMask usedBlocks, bool watched);
+   template <int WORDS>
+   void estimateSearch(const placementTable<WORDS> &, blockMask usedBlocks, int probes,
+                       double &nodes, double &solutions, double &seconds);
+   void buildPlacementTable(void);
+   std::unique_ptr<transpositionCache<1> > &keptCache(const placementTable<1> &) {return smallCache;}
+   std::unique_ptr<transpositionCache<2> > &keptCache(const placementTable<2> &) {return mediumCache;}
+   std::unique_ptr<transpositionCache<PUZZLE_BITBOARD_WORDS> > &
+     keptCache(const placementTable<PUZZLE_BITBOARD_WORDS> &) {return largeCache;}
+   void dropKeptCaches(void);
+   void hashBlockSet(void);
+   block &heldBlock(void) {return blocks[currentBlock];}
+
    bool blockFits(const pos);
+   int  maskShift(const pos);
    void drawBlock(pos p, COLORREF colour);
    void updateGrid(void);
    pos  findNextEmptyPos(void);
-   bool solveRecursively(ofstream);
    void drawSquare(const COLORREF, int, int);
-
-   COLORREF grid[MAX_PUZZLE_HEIGHT][MAX_PUZZLE_WIDTH];
-   block *currentBlockPtr;
+   void getGridColours(std::vector<COLORREF> &colours);
+   void removeAllBlocks(void);
+   int  addTextSolution(std::istream &, std::vector<piecePlacement> &);
+   bool openSolutionFile(void);
+   piecePlacement pieceOf(int b);
+
+   COLORREF grid[MAX_PUZZLE_HEIGHT][MAX_PUZZLE_WIDTH]; // colours for drawing only
+   puzzleBitboard occupied; // occupied squares (see "bitboard.h"), including 'blocked'
+   puzzleBitboard blocked;  // squares of grid not open in 'shape'
+   board shape;
+   blockSet blocks;           // block set in order read from file (block 'i' is blocks[i])
+   std::string readError;     // see "getReadError"
+   int numberOfBlocks,
+       currentBlock; // index of block held, NO_BLOCK if none
+   placementTable<1>                     smallTable;  // used if "gridWords" is 1
+   placementTable<2>                     mediumTable; // used if "gridWords" is 2
+   placementTable<PUZZLE_BITBOARD_WORDS> largeTable;  // used otherwise
+   solutionQueue   output;         // passes solutions found by "solve" to writer thread
+   solutionReader  solutionsRead;  // binary file read by "viewSolution"
+   textSolutionIndex solutionLines; // text file read by "viewSolution"
+   std::string solutionFileName;
+   solutionFormat format;
+   unsigned long long blockHash;
+   puzzleView *view;
+   solverEngine engine;
+   int threads,
+       splitDepth,
+       symmetryCount; // number of symmetric solutions each solution found represents
+   bool breakSymmetry,
+        expandSymmetry,
+        pruning,
+        countOnly,
+        limitReached; // last solve stopped by "solutionLimit"
+   long solutionLimit;
+   size_t cacheBytes;
+   cacheReplacement cachePolicy;
+   bool keepCache; // see "setKeepCache"
+   std::unique_ptr<transpositionCache<1> >                     smallCache;  // kept caches, one
+   std::unique_ptr<transpositionCache<2> >                     mediumCache; // for each table
+   std::unique_ptr<transpositionCache<PUZZLE_BITBOARD_WORDS> > largeCache;
+   cacheStats cacheCounts; // of last solve
+   long prunedCount, // placements abandoned by dead region pruning in last solve
+        nodeCount,   // search nodes visited in last solve
+        testedCount; // placements tested for fit in last solve
+   searchStats stats;
    int height,
        width,
+       gridWords, // words of bitboard searched: 1, 2 (see "bitboard.h") or PUZZLE_BITBOARD_WORDS
        solutionCount;
    bool solving,
-        foundSolution;
-   double percentSolved;
+        foundSolution,
+        completed; // see "getCompleted"
+   double percentSolved,
+          timeTaken,
+          estimatedNodes; // see "getEstimatedNodes"
+   bool estimateProgress; // see "setEstimateProgress"
+   std::function<double(int)> refineEstimate; // follows more paths during solve (see "poll")
+   std::function<void(const piecePlacement *, int)> solutionHandler; // see "setSolutionHandler"
+   std::chrono::steady_clock::time_point deadline; // see "setDeadline"
+   const std::atomic<bool> *cancelFlag;
+   searchWatcher *watcher; // see "setWatcher"
+   std::chrono::steady_clock::time_point startTime; // of "solve"
    pos nextEmptyPos;
-   stack<block *> S; // blocks in puzzle grid
-   queue<block *> Q; // blocks waiting to be added to puzzle grid
-   // PROBLEM: for Q & S, should be able to set max size using constructor
-   char textBuffer[30]; // holds most recent text message drawn
-};
-
+   int placed[MAX_NUMBER_BLOCKS], // blocks in puzzle grid (in order added)
+       placedCount;
+   blockMask inGrid,  // blocks in 'placed'
+             waiting; // blocks neither in puzzle grid nor held
+   int nextBlock;     // "pickUpBlock" takes first waiting block from here on
+   char textBuffer[64], // holds most recent text message drawn
+        report[300];    // message shown at end of "solve"
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "renderer.h" - Class "renderer" definition.                                                     *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "colour.h"
+
+/*
+ * Drawing surface used by "gridView": an off-screen back buffer that
+ * is drawn into and then shown a rectangle at a time.  Implemented with
+ * GDI for the Windows program ("winrender.h") and in memory for tests
+ * and benchmarks on any platform ("framebuf.h").  Coordinates are in
+ * pixels from the top left of the buffer.
+ */
+class renderer {
+ public:
+   virtual ~renderer(void) {}
+
+   /*
+    * Make the back buffer 'width' x 'height' pixels, cleared to black.
+    */
+   virtual void resize(int width, int height) = 0;
+
+   /*
+    * Fill rectangle 'w' x 'h' at ('x', 'y') of the back buffer with 'colour'.
+    */
+   virtual void fillRect(int x, int y, int w, int h, COLORREF colour) = 0;
+
+   /*
+    * Write 'text' at ('x', 'y') of the back buffer in 'colour'.
+    */
+   virtual void drawText(int x, int y, const char *text, COLORREF colour) = 0;
+
+   /*
+    * Show rectangle 'w' x 'h' at ('x', 'y') of the back buffer on screen.
+    */
+   virtual void present(int x, int y, int w, int h) = 0;
+};
+
+#endif
@@ -0,0 +1,325 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "search.h" - Class template "backtrackSearch" definition.                                       *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "placement.h"
+#include "stats.h"
+#include "cache.h"
+#include "snapshot.h"
+
+#define SEARCH_POLL_INTERVAL 1024 // nodes searched between calls to "searchObserver::poll"
+
+/*
+ * Receives solutions and progress reports from a search.
+ */
+class searchObserver {
+ public:
+   virtual ~searchObserver(void) {}
+
+   /*
+    * Called for each solution found.  'pieces[0..n-1]' are the blocks
+    * placed by the search in the order they were placed.  Return
+    * false to halt the search (eg. once enough solutions are found).
+    */
+   virtual bool solution(const piecePlacement *pieces, int n) = 0;
+
+   /*
+    * Called instead of "solution" for 'n' solutions found at once by a
+    * search only counting solutions (see "backtrackSearch::setCache").
+    * Return false to halt the search.
+    */
+   virtual bool solutionsCounted(long n) = 0;
+
+   /*
+    * Called periodically during the search with the search's own
+    * (rough) measure of progress and the number of nodes searched so
+    * far.  Return false to halt it.
+    */
+   virtual bool poll(double percentSolved, long nodes) = 0;
+};
+
+/*
+ * Backtracking search for every way of filling the empty squares of a
+ * puzzle grid with blocks not yet used.  The first empty square (looking
+ * at the grid left->right & top->bottom) is always filled next, trying
+ * each placement in the table anchored on that square.
+ *
+ * With pruning on, each placement is followed by a flood fill of the
+ * empty regions it touches.  If a region is smaller than every remaining
+ * block, or its size is not the sum of the sizes of any of the remaining
+ * blocks, the placement is abandoned at once instead of when the search
+ * later reaches a square no block can cover.
+ */
+template <int WORDS>
+class backtrackSearch {
+ public:
+   backtrackSearch(const placementTable<WORDS> &t, searchObserver &o)
+     : table(t), observer(o) {pruning = false; cache = NULL; counting = false; mailbox = NULL;}
+
+   /*
+    * Turn dead region pruning on or off (off by default).
+    */
+   void setPruning(bool p) {pruning = p;}
+
+   /*
+    * Look up each state (squares occupied, blocks used) in 'c' before
+    * searching below it, and store the result afterwards (NULL for no
+    * cache).  States with no solutions below them are skipped.  If
+    * 'countOnly' is set, states with solutions below them are skipped
+    * too, their solutions passed to "searchObserver::solutionsCounted".
+    */
+   void setCache(transpositionCache<WORDS> *c, bool countOnly) {
+      cache    = c;
+      counting = countOnly;
+   }
+
+   /*
+    * Publish snapshots of the search to 'm' as often as it asks (NULL,
+    * the default, for none).  Looked at only every SEARCH_POLL_INTERVAL
+    * nodes, so the search is no slower for it.
+    */
+   void setMailbox(snapshotMailbox *m) {mailbox = m;}
+
+   /*
+    * Find all solutions from the state described by 'occupied' (squares
+    * already filled) and 'usedBlocks' (bit 'i' set if block 'i' is
+    * already in the puzzle).  Return true if the search ran to
+    * completion, false if halted by the observer.
+    */
+   bool run(const bitboard<WORDS> &occupied, const blockMask usedBlocks) {
+      occ           = occupied;
+      used          = usedBlocks;
+      depth         = 0;
+      nodes         = 0;
+      tested        = 0;
+      pruned        = 0;
+      solutionCount = 0;
+      percentSolved = 0;
+      stats.reset(table.getBlockCount());
+      if (pruning)
+        initPruning();
+
+      int cell = occ.firstClear(0, table.getCells());
+      if (cell == table.getCells())
+        return true; // nothing to solve
+      return solveRecursively(cell);
+   }
+
+   long   getSolutionCount(void) const {return solutionCount;}
+   long   getNodeCount(void) const     {return nodes;        }
+   double getPercentSolved(void) const {return percentSolved;}
+
+   /*
+    * Return number of placements tested for fit.
+    */
+   long getTestedCount(void) const {return tested;}
+
+   /*
+    * Return number of placements abandoned by dead region pruning.
+    */
+   long getPrunedCount(void) const {return pruned;}
+
+   /*
+    * Return statistics of last run (empty unless compiled with
+    * SEARCH_STATS, see "stats.h").
+    */
+   const searchStats &getStats(void) const {return stats;}
+
+ private:
+   bool solveRecursively(const int cell) {
+      if (++nodes % SEARCH_POLL_INTERVAL == 0) {
+         if (!observer.poll(percentSolved, nodes))
+           return false;
+         if (mailbox != NULL && mailbox->due())
+           mailbox->publish(occ, pieces, depth, nodes);
+      }
+      stats.node(depth);
+
+      // skip state if searched before (including the start state, if the
+      // cache is kept between searches)
+      long cached;
+      bool known = cache != NULL && cache->find(occ, used, cached);
+      if (known && cached == 0)
+        return true; // dead
+      if (known && counting) {
+         solutionCount += cached;
+         return observer.solutionsCounted(cached);
+      }
+      long startSolutions = solutionCount,
+           startNodes     = nodes;
+
+      int first = table.first(cell),
+          last  = table.last(cell),
+          fits  = 0,
+          i;
+      tested += last - first;
+      for (i = first; i < last; ++i) {
+         const placement<WORDS> &p = table[i];
+
+         // update progress each time the puzzle is cleared
+         if (depth == 0) {
+            if (!observer.poll(percentSolved, nodes))
+              return false;
+            percentSolved += 100 / (double)(last - first);
+         }
+
+         if ((used >> p.piece.block) & 1)
+           continue;
+         stats.test(depth, p.piece.block);
+         if (!table.fits(p, occ))
+           continue;
+         stats.fit(depth, p.piece.block);
+         ++fits;
+
+         table.toggle(p, occ);
+         used |= (blockMask)1 << p.piece.block;
+         pieces[depth++] = p.piece;
+
+         int next = occ.firstClear(cell + 1, table.getCells());
+         if (next == table.getCells()) {
+            ++solutionCount;
+            if (!observer.solution(pieces, depth))
+              return false;
+         }
+         else if (pruning && deadRegion(p)) {
+            ++pruned;
+            stats.prune(depth - 1, p.piece.block);
+         }
+         else if (!solveRecursively(next))
+           // solution process has been halted early
+           return false;
+
+         --depth;
+         used &= ~((blockMask)1 << p.piece.block);
+         table.toggle(p, occ);
+      }
+      if (fits == 0)
+        stats.deadEnd(depth, depth > 0 ? pieces[depth - 1].block : -1);
+      if (cache != NULL && !known)
+        cache->store(occ, used, solutionCount - startSolutions, nodes - startNodes + 1);
+      return true;
+   }
+
+   /*
+    * Set up masks used by "deadRegion".
+    */
+   void initPruning(void) {
+      int width = table.getWidth(), i;
+      allSquares.clear();
+      notFirstColumn.clear();
+      notLastColumn.clear();
+      for (i = 0; i < table.getCells(); ++i) {
+         allSquares.set(i);
+         if (i % width != 0)
+           notFirstColumn.set(i);
+         if (i % width != width - 1)
+           notLastColumn.set(i);
+      }
+   }
+
+   /*
+    * Return squares sharing an edge with a square in 'b'.
+    */
+   bitboard<WORDS> neighbours(const bitboard<WORDS> &b) const {
+      bitboard<WORDS> n = b, t = b;
+      n.shiftLeft(1);              // right
+      n &= notFirstColumn;
+      t.shiftRight(1);             // left
+      t &= notLastColumn;
+      n |= t;
+      t = b;
+      t.shiftLeft(table.getWidth());  // below
+      n |= t;
+      t = b;
+      t.shiftRight(table.getWidth()); // above
+      n |= t;
+      return n;
+   }
+
+   /*
+    * Test whether the block just placed ('p') has left an empty region
+    * next to it that cannot be filled with remaining blocks.  Return
+    * true if so.
+    */
+   bool deadRegion(const placement<WORDS> &p) {
+      bitboard<WORDS> empty = allSquares,
+                      seeds, region, grown;
+      table.getMask(p, seeds);
+      seeds = neighbours(seeds);
+      empty.andNot(occ);
+      seeds &= empty;
+      if (seeds.empty())
+        return false;
+
+      // smallest remaining block
+      int smallest = table.getCells() + 1, i;
+      for (i = 0; i < table.getBlockCount(); ++i)
+        if (!((used >> i) & 1) && table.getBlockSize(i) < smallest)
+          smallest = table.getBlockSize(i);
+
+      bool haveSums = false;
+      while (!seeds.empty()) {
+         // flood fill region containing first seed
+         region.clear();
+         region.set(seeds.firstSet());
+         for (;;) {
+            grown = neighbours(region);
+            grown |= region;
+            grown &= empty;
+            if (grown == region)
+              break;
+            region = grown;
+         }
+
+         int size = region.count();
+         if (size < smallest)
+           return true;
+         if (!haveSums) {
+            // sizes that can be made from remaining blocks
+            sums.clear();
+            sums.set(0);
+            for (i = 0; i < table.getBlockCount(); ++i)
+              if (!((used >> i) & 1)) {
+                 bitboard<WORDS> s = sums;
+                 s.shiftLeft(table.getBlockSize(i));
+                 sums |= s;
+              }
+            haveSums = true;
+         }
+         if (!sums.test(size))
+           return true;
+         seeds.andNot(region);
+      }
+      return false;
+   }
+
+   const placementTable<WORDS> &table;
+   searchObserver &observer;
+   transpositionCache<WORDS> *cache;
+   bool counting; // take solution counts from cache
+   snapshotMailbox *mailbox;
+   bitboard<WORDS> occ,
+                   allSquares,     // every square of grid
+                   notFirstColumn, // every square not in first column
+                   notLastColumn,  // every square not in last column
+                   sums;           // bit 'n' set if remaining blocks can fill 'n' squares
+   bool pruning;
+   blockMask used;
+   piecePlacement pieces[MAX_NUMBER_BLOCKS]; // blocks placed so far
+   int  depth;
+   long nodes,
+        tested,
+        pruned,
+        solutionCount;
+   double percentSolved;
+   searchStats stats;
+};
+
+#endif
@@ -0,0 +1,63 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "snapshot.cpp" - Member functions of class "snapshotMailbox" (defined in "snapshot.h").         *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include "snapshot.h"
+
+#define SNAPSHOT_FRESH 4 // added to slot number in 'latest' until it is taken
+
+using namespace std;
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Constructor.
+ */
+snapshotMailbox::snapshotMailbox(void) {
+   setRate(SNAPSHOT_RATE);
+   reset();
+}
+
+/*
+ * Publish at most 'perSecond' snapshots a second.
+ */
+void snapshotMailbox::setRate(const double perSecond) {
+   interval = chrono::duration_cast<chrono::steady_clock::duration>(
+                chrono::duration<double>(perSecond > 0 ? 1 / perSecond : 0));
+}
+
+/*
+ * Empty mailbox and start timing from now.
+ */
+void snapshotMailbox::reset(void) {
+   back      = 0;
+   latest    = 1;
+   front     = 2;
+   published = 0;
+   start     = chrono::steady_clock::now();
+   next      = start;
+}
+
+/*
+ * Return latest snapshot not yet taken, or NULL.
+ */
+const searchSnapshot *snapshotMailbox::take(void) {
+   if (!(latest.load(memory_order_relaxed) & SNAPSHOT_FRESH))
+     return NULL;
+   front = latest.exchange(front, memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+   return &slots[front];
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Make slot just written the latest, and take the one it replaces
+ * (or the reader gave back) to write next.
+ */
+void snapshotMailbox::swapBack(void) {
+   back = latest.exchange(back | SNAPSHOT_FRESH, memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+}
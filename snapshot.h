@@ -0,0 +1,109 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "snapshot.h" - Class "snapshotMailbox" definition.                                              *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <chrono>
+
+#include "placement.h"
+
+#define SNAPSHOT_RATE 30 // default snapshots published per second
+
+/*
+ * State of a search at one moment: the squares filled and the blocks
+ * it has placed, in the order placed.
+ */
+struct searchSnapshot {
+   long   sequence; // 1 for the first snapshot published since "reset", and so on
+   long   nodes;    // searched so far
+   double seconds;  // since "reset"
+   int    depth;    // blocks in 'pieces'
+   piecePlacement pieces[MAX_NUMBER_BLOCKS];
+   int    words;    // words of 'occupied' used
+   bbWord occupied[PUZZLE_BITBOARD_WORDS];
+};
+
+/*
+ * Passes the latest snapshot of a search to one other thread without
+ * locks, so that a view may follow a search while costing it almost
+ * nothing.  The search (the one producer) asks "due" every
+ * SEARCH_POLL_INTERVAL nodes and fills in a snapshot only once the
+ * publishing interval has passed; the reader samples whenever it likes
+ * and gets the latest snapshot, those replaced before it looked being
+ * dropped.  Three slots are used: one written by the search, one held
+ * by the reader and the latest published, exchanged with the others
+ * by a single atomic swap, so neither side ever waits for the other.
+ */
+class snapshotMailbox {
+ public:
+   snapshotMailbox(void);
+
+   /*
+    * Publish at most 'perSecond' snapshots a second (SNAPSHOT_RATE by
+    * default).
+    */
+   void setRate(double perSecond);
+
+   /*
+    * Empty mailbox and start timing snapshots from now.  Must not be
+    * called while the search or reader is using the mailbox.
+    */
+   void reset(void);
+
+   /*
+    * Return whether the search should publish a snapshot now.
+    */
+   bool due(void) const {return std::chrono::steady_clock::now() >= next;}
+
+   /*
+    * Publish snapshot of a search with 'occ' filled, having placed
+    * 'pieces[0..n-1]' and searched 'nodes' nodes (search thread only).
+    */
+   template <int WORDS>
+   void publish(const bitboard<WORDS> &occ, const piecePlacement *pieces, int n, long nodes) {
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      searchSnapshot &s = slots[back];
+      s.sequence = ++published;
+      s.nodes    = nodes;
+      s.seconds  = std::chrono::duration<double>(now - start).count();
+      s.depth    = n;
+      s.words    = WORDS;
+      for (int i = 0; i < n; ++i)
+        s.pieces[i] = pieces[i];
+      for (int i = 0; i < WORDS; ++i)
+        s.occupied[i] = occ.word(i);
+      swapBack();
+      next = now + interval;
+   }
+
+   /*
+    * Return latest snapshot not yet taken, or NULL if none has been
+    * published since the last (reader thread only).  The snapshot
+    * stays valid until the next call.
+    */
+   const searchSnapshot *take(void);
+
+ private:
+   snapshotMailbox(const snapshotMailbox &);            // not copyable
+   snapshotMailbox &operator=(const snapshotMailbox &);
+
+   void swapBack(void);
+
+   searchSnapshot slots[3];
+   std::atomic<int> latest; // slot published last, plus SNAPSHOT_FRESH if not taken
+   int  back,               // slot written by search
+        front;              // slot held by reader
+   long published;
+   std::chrono::steady_clock::duration   interval;
+   std::chrono::steady_clock::time_point start,
+                                         next; // time next snapshot is due
+};
+
+#endif
@@ -0,0 +1,394 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "solfile.cpp" - Member functions of classes "solutionWriter", "solutionReader" and              *
+*                 "textSolutionIndex" (defined in "solfile.h").                                   *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "solfile.h"
+
+using namespace std;
+
+// little endian encoding of header fields and records
+static void put(unsigned char *p, unsigned long long v, int bytes) {
+   for (int i = 0; i < bytes; ++i, v >>= 8)
+     p[i] = (unsigned char)(v & 0xff);
+}
+
+static unsigned long long get(const unsigned char *p, int bytes) {
+   unsigned long long v = 0;
+   for (int i = bytes - 1; i >= 0; --i)
+     v = v << 8 | p[i];
+   return v;
+}
+
+static void putPiece(unsigned char *p, const piecePlacement &piece) {
+   put(p,     piece.block,       1);
+   put(p + 1, piece.orientation, 1);
+   put(p + 2, piece.anchor,      2);
+}
+
+static piecePlacement getPiece(const unsigned char *p) {
+   piecePlacement piece;
+   piece.block       = (int)get(p,     1);
+   piece.orientation = (int)get(p + 1, 1);
+   piece.anchor      = (int)get(p + 2, 2);
+   return piece;
+}
+
+// FUNCTIONS //////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Return hash (FNV-1a) of the colours and shapes of blocks 'blocks[0..n-1]'.
+ */
+unsigned long long blockSetHash(block blocks[], const int n) {
+   unsigned long long hash = 14695981039346656037ULL;
+   int i, o, r, c;
+   for (i = 0; i < n; ++i) {
+      block *bPtr = &blocks[i];
+      o = bPtr->getOrientation();
+      bPtr->changeOrientation(0);
+      unsigned long long values[3] = {bPtr->getColour(),
+                                      (unsigned long long)bPtr->getHeight(),
+                                      (unsigned long long)bPtr->getWidth()};
+      for (c = 0; c < 3; ++c)
+        for (r = 0; r < 4; ++r)
+          hash = (hash ^ ((values[c] >> (8 * r)) & 0xff)) * 1099511628211ULL;
+      for (r = 0; r < bPtr->getHeight(); ++r)
+        for (c = 0; c < bPtr->getWidth(); ++c)
+          hash = (hash ^ (bPtr->getGrid(r, c) ? 1 : 0)) * 1099511628211ULL;
+      bPtr->changeOrientation(o);
+   }
+   return hash;
+}
+
+/*
+ * Test whether file 'fileName' is a binary solution file.
+ */
+bool isBinarySolutionFile(const char *fileName) {
+   ifstream file(fileName, ios::binary);
+   char magic[8];
+   return file.read(magic, 8) && memcmp(magic, SOLUTION_FILE_MAGIC, 8) == 0;
+}
+
+// SOLUTIONWRITER /////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Create file 'fileName' described by 'info'.
+ */
+bool solutionWriter::open(const char *fileName, const solutionFileInfo &info) {
+   close();
+   buffer.resize(SOLUTION_FILE_BUFFER_SIZE);
+   file.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+   file.open(fileName, ios::binary | ios::trunc);
+   if (!file)
+     return false;
+
+   int nInitial = (int)info.initial.size(), i;
+   stride = SOLUTION_PIECE_SIZE * (1 + info.blockCount - nInitial);
+   count  = 0;
+   record.assign(stride, 0);
+
+   vector<unsigned char> header(SOLUTION_FILE_HEADER_SIZE + SOLUTION_PIECE_SIZE * nInitial, 0);
+   memcpy(&header[0], SOLUTION_FILE_MAGIC, 8);
+   put(&header[8],  SOLUTION_FILE_VERSION, 4);
+   put(&header[12], info.height,     2);
+   put(&header[14], info.width,      2);
+   put(&header[16], info.blockCount, 2);
+   put(&header[18], nInitial,        2);
+   put(&header[20], stride,          4);
+   put(&header[24], info.hash,       8);
+   put(&header[32], 0,               8);
+   put(&header[40], header.size(),   8);
+   for (i = 0; i < nInitial; ++i)
+     putPiece(&header[SOLUTION_FILE_HEADER_SIZE + SOLUTION_PIECE_SIZE * i], info.initial[i]);
+   file.write((const char *)&header[0], header.size());
+   return (bool)file;
+}
+
+/*
+ * Append solution 'pieces[0..n-1]'.
+ */
+void solutionWriter::write(const piecePlacement *pieces, const int n) {
+   assert(SOLUTION_PIECE_SIZE * (n + 1) <= stride);
+   put(&record[0], n, 2);
+   for (int i = 0; i < n; ++i)
+     putPiece(&record[SOLUTION_PIECE_SIZE * (i + 1)], pieces[i]);
+   file.write((const char *)&record[0], stride);
+   ++count;
+}
+
+/*
+ * Record number of solutions in header and close file.
+ */
+void solutionWriter::close(void) {
+   if (!file.is_open())
+     return;
+   unsigned char n[8];
+   put(n, count, 8);
+   file.seekp(32);
+   file.write((const char *)n, 8);
+   file.close();
+}
+
+// SOLUTIONREADER /////////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Open file 'fileName'.  Return false if it is not a binary solution file.
+ */
+bool solutionReader::open(const char *fileName) {
+   if (!file.open(fileName))
+     return false;
+   const unsigned char *header = file.getData();
+   unsigned long long size = file.getSize();
+   if (size < SOLUTION_FILE_HEADER_SIZE
+       || memcmp(header, SOLUTION_FILE_MAGIC, 8) != 0
+       || get(&header[8], 4) != SOLUTION_FILE_VERSION) {
+      close();
+      return false;
+   }
+
+   info.height     = (int)get(&header[12], 2);
+   info.width      = (int)get(&header[14], 2);
+   info.blockCount = (int)get(&header[16], 2);
+   int nInitial    = (int)get(&header[18], 2), i;
+   stride          = (int)get(&header[20], 4);
+   info.hash       = get(&header[24], 8);
+   count           = (long long)get(&header[32], 8);
+   dataOffset      = (long long)get(&header[40], 8);
+
+   if (stride < SOLUTION_PIECE_SIZE
+       || (unsigned long long)(SOLUTION_FILE_HEADER_SIZE + SOLUTION_PIECE_SIZE * nInitial) > size
+       || (unsigned long long)dataOffset > size) {
+      close();
+      return false;
+   }
+   info.initial.clear();
+   for (i = 0; i < nInitial; ++i)
+     info.initial.push_back(getPiece(&header[SOLUTION_FILE_HEADER_SIZE + SOLUTION_PIECE_SIZE * i]));
+
+   // file not closed properly by writer: count records present
+   long long present = (long long)(size - dataOffset) / stride;
+   if (count == 0 || count > present)
+     count = present;
+   return true;
+}
+
+/*
+ * Read solution 'i' into 'pieces'.
+ */
+bool solutionReader::read(const long long i, vector<piecePlacement> &pieces) {
+   pieces.clear();
+   if (i < 0 || i >= count)
+     return false;
+   const unsigned char *record = file.getData() + dataOffset + i * stride;
+   int n = (int)get(record, 2);
+   if (SOLUTION_PIECE_SIZE * (n + 1) > stride)
+     return false;
+   for (int j = 0; j < n; ++j)
+     pieces.push_back(getPiece(&record[SOLUTION_PIECE_SIZE * (j + 1)]));
+   return true;
+}
+
+// TEXTSOLUTIONINDEX //////////////////////////////////////////////////////////////////////////////
+
+#define TEXT_INDEX_MAGIC       "BPIDX002"
+#define TEXT_INDEX_HEADER_SIZE 48
+#define TEXT_INDEX_SAMPLE      4096      // bytes at each end of solution file checksummed
+#define TEXT_INDEX_FLUSH_LINES (1 << 20) // new offsets held in memory before saving them
+
+/*
+ * Open text solution file 'fileName'.
+ */
+bool textSolutionIndex::open(const char *fileName) {
+   close();
+   if (!file.open(fileName))
+     return false;
+   indexName = string(fileName) + TEXT_INDEX_SUFFIX;
+   checksum  = sampleChecksum();
+   if (!load()) {
+      indexed = 0;
+      offsets.clear();
+      if (file.getSize() > 0)
+        offsets.push_back(0);
+      scanned = 0;
+   }
+   return true;
+}
+
+/*
+ * Save index (if it has grown) and close file.
+ */
+void textSolutionIndex::close(void) {
+   if (!file.isOpen())
+     return;
+   if (!offsets.empty())
+     save();
+   file.close();
+   index.close();
+   offsets.clear();
+   indexed = 0;
+   scanned = 0;
+}
+
+/*
+ * Set 'text' and 'length' to line 'i'.
+ */
+bool textSolutionIndex::line(const long long i, const char *&text, size_t &length) {
+   if (i < 0)
+     return false;
+   scanTo(i + 1);
+   if (i >= getKnownLines())
+     return false;
+   unsigned long long start = offset(i),
+                      end   = i + 1 < getKnownLines() ? offset(i + 1) : scanned;
+   text = (const char *)file.getData() + start;
+   while (end > start && (text[end - start - 1] == '\n' || text[end - start - 1] == '\r'))
+     --end;
+   length = (size_t)(end - start);
+   return true;
+}
+
+/*
+ * Return number of lines in file.
+ */
+long long textSolutionIndex::getLineCount(void) {
+   scanTo(-1);
+   return getKnownLines();
+}
+
+/*
+ * Delete index of text solution file 'fileName'.
+ */
+void textSolutionIndex::discard(const char *fileName) {
+   remove((string(fileName) + TEXT_INDEX_SUFFIX).c_str());
+}
+
+/*
+ * Return start of line 'i' (one of the lines found so far).
+ */
+unsigned long long textSolutionIndex::offset(const long long i) {
+   if ((unsigned long long)i < indexed)
+     return get(index.getData() + TEXT_INDEX_HEADER_SIZE + 8 * i, 8);
+   return offsets[(size_t)(i - indexed)];
+}
+
+/*
+ * Scan file for line breaks until start of line 'i' is known, or to
+ * end of file if 'i' is negative.  The last line ends at end of file
+ * ('scanned') once the whole file has been scanned.  Every
+ * TEXT_INDEX_FLUSH_LINES lines found the new offsets are saved, so
+ * that memory held does not grow with the file.
+ */
+void textSolutionIndex::scanTo(const long long i) {
+   const unsigned char *data = file.getData();
+   unsigned long long size = file.getSize();
+   while ((i < 0 || getKnownLines() <= i) && scanned < size) {
+      const void *lineBreak = memchr(data + scanned, '\n', (size_t)(size - scanned));
+      if (lineBreak == NULL) {
+         scanned = size;
+         break;
+      }
+      scanned = (const unsigned char *)lineBreak - data + 1;
+      if (scanned < size) {
+         offsets.push_back(scanned);
+         if (offsets.size() % TEXT_INDEX_FLUSH_LINES == 0)
+           save(); // kept in memory if it cannot be saved
+      }
+   }
+}
+
+/*
+ * Map index file.  Return false if it is missing or was made for
+ * another version of the solution file.
+ */
+bool textSolutionIndex::load(void) {
+   if (!index.open(indexName.c_str()) || index.getSize() < TEXT_INDEX_HEADER_SIZE) {
+      index.close();
+      return false;
+   }
+   const unsigned char *header = index.getData();
+   unsigned long long n = get(&header[40], 8);
+   if (memcmp(header, TEXT_INDEX_MAGIC, 8) != 0
+       || get(&header[8], 8) != file.getSize()
+       || get(&header[16], 8) != file.getModified()
+       || get(&header[24], 8) != checksum
+       || get(&header[32], 8) > file.getSize()
+       || n > (index.getSize() - TEXT_INDEX_HEADER_SIZE) / 8) {
+      index.close();
+      return false;
+   }
+   scanned = get(&header[32], 8);
+   indexed = n;
+   offsets.clear();
+   return true;
+}
+
+/*
+ * Append offsets found since the last save to index file (creating it
+ * if there is none), then map it again to reach them.  Return false
+ * (keeping them in memory) if it cannot be written, eg. read only
+ * directory; the next "open" then has to scan the file again.
+ */
+bool textSolutionIndex::save(void) {
+   unsigned char header[TEXT_INDEX_HEADER_SIZE];
+   memcpy(header, TEXT_INDEX_MAGIC, 8);
+   put(&header[8],  file.getSize(),                 8);
+   put(&header[16], file.getModified(),             8);
+   put(&header[24], checksum,                       8);
+   put(&header[32], scanned,                        8);
+   put(&header[40], indexed + offsets.size(),       8);
+   vector<unsigned char> buffer(8 * offsets.size());
+   for (size_t j = 0; j < offsets.size(); ++j)
+     put(&buffer[8 * j], offsets[j], 8);
+
+   // new offsets first, so that the header never counts offsets not written
+   fstream out(indexName.c_str(), indexed > 0 ? ios::binary | ios::in | ios::out
+                                              : ios::binary | ios::out | ios::trunc);
+   bool ok = out.seekp(TEXT_INDEX_HEADER_SIZE + 8 * indexed)
+             && out.write((const char *)&buffer[0], buffer.size())
+             && out.seekp(0) && out.write((const char *)header, sizeof(header)) && out.flush();
+   out.close();
+   if (!ok) {
+      if (indexed == 0)
+        remove(indexName.c_str());
+      return false;
+   }
+
+   unsigned long long n = indexed + offsets.size();
+   if (!index.open(indexName.c_str()) || index.getSize() < TEXT_INDEX_HEADER_SIZE + 8 * n) {
+      // cannot reach offsets saved: find them again
+      index.close();
+      indexed = 0;
+      offsets.assign(1, 0);
+      scanned = 0;
+      return false;
+   }
+   indexed = n;
+   offsets.clear();
+   return true;
+}
+
+/*
+ * Return checksum (FNV-1a) of the first and last TEXT_INDEX_SAMPLE
+ * bytes of solution file, so that a file rewritten with the same size
+ * within the resolution of its modification time is still noticed
+ * unless its ends are unchanged too.
+ */
+unsigned long long textSolutionIndex::sampleChecksum(void) {
+   const unsigned char *data = file.getData();
+   unsigned long long size = file.getSize(),
+                      head = size < TEXT_INDEX_SAMPLE ? size : TEXT_INDEX_SAMPLE,
+                      tail = size - head < TEXT_INDEX_SAMPLE ? size - head : TEXT_INDEX_SAMPLE,
+                      hash = 14695981039346656037ULL, j;
+   for (j = 0; j < head; ++j)
+     hash = (hash ^ data[j]) * 1099511628211ULL;
+   for (j = size - tail; j < size; ++j)
+     hash = (hash ^ data[j]) * 1099511628211ULL;
+   return hash;
+}
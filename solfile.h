@@ -0,0 +1,203 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "solfile.h" - Classes "solutionWriter", "solutionReader" and "textSolutionIndex" definitions.    *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef SOLFILE_H
+#define SOLFILE_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "placement.h"
+#include "mapfile.h"
+
+/*
+ * Binary solution file.  All numbers are little endian.
+ *
+ *   offset  size  contents
+ *        0     8  "BPSOLN01"
+ *        8     4  version (1)
+ *       12     2  puzzle grid height
+ *       14     2  puzzle grid width
+ *       16     2  number of blocks in block set
+ *       18     2  number of blocks in puzzle before solving ("initial")
+ *       20     4  stride (bytes per solution record)
+ *       24     8  hash of block set (see "blockSetHash")
+ *       32     8  number of solutions
+ *       40     8  offset of first solution record
+ *       48         initial blocks, 4 bytes each
+ *
+ * followed by one record of "stride" bytes per solution, so solution
+ * 'i' (from 0) starts at offset + i * stride.  A record holds the
+ * number of blocks placed (2 bytes, then 2 unused) and then for each
+ * block its index in the block set (1 byte), orientation (1 byte) and
+ * anchor square (2 bytes), in the order placed.
+ */
+#define SOLUTION_FILE_MAGIC       "BPSOLN01"
+#define SOLUTION_FILE_VERSION     1
+#define SOLUTION_FILE_HEADER_SIZE 48
+#define SOLUTION_PIECE_SIZE       4
+#define SOLUTION_FILE_BUFFER_SIZE (1 << 20) // bytes written to solution file at once
+#define TEXT_INDEX_SUFFIX         ".idx" // appended to name of text solution file for its index
+
+/*
+ * Return hash (FNV-1a) of the colours and shapes of blocks 'blocks[0..n-1]'
+ * as read from a block set file (orientation 0).
+ */
+unsigned long long blockSetHash(block blocks[], int n);
+
+/*
+ * Test whether file 'fileName' is a binary solution file.
+ */
+bool isBinarySolutionFile(const char *fileName);
+
+/*
+ * Header of a binary solution file.
+ */
+struct solutionFileInfo {
+   int height,
+       width,
+       blockCount;
+   unsigned long long hash;
+   std::vector<piecePlacement> initial; // blocks in puzzle before solving
+};
+
+/*
+ * Writes solutions to a binary solution file.
+ */
+class solutionWriter {
+ public:
+   solutionWriter(void) {count = 0; stride = 0;}
+   ~solutionWriter(void) {close();}
+
+   /*
+    * Create file 'fileName' described by 'info'.  Return false if it
+    * cannot be written.
+    */
+   bool open(const char *fileName, const solutionFileInfo &info);
+
+   /*
+    * Append solution 'pieces[0..n-1]'.
+    */
+   void write(const piecePlacement *pieces, int n);
+
+   /*
+    * Record number of solutions in header and close file.
+    */
+   void close(void);
+
+   long long getCount(void) const {return count;}
+
+ private:
+   std::vector<char> buffer; // see SOLUTION_FILE_BUFFER_SIZE
+   std::ofstream file;
+   std::vector<unsigned char> record;
+   long long count;
+   int stride;
+};
+
+/*
+ * Reads solutions from a binary solution file in any order.  The file
+ * is mapped into memory (see "mapfile.h"), so reading a solution costs
+ * no more than touching the page holding its record.
+ */
+class solutionReader {
+ public:
+   solutionReader(void) {count = 0; stride = 0; dataOffset = 0;}
+
+   /*
+    * Open file 'fileName'.  Return false if it is not a binary
+    * solution file.
+    */
+   bool open(const char *fileName);
+   void close(void) {file.close();}
+   bool isOpen(void) const {return file.isOpen();}
+
+   const solutionFileInfo &getInfo(void) const {return info;}
+   long long getCount(void) const {return count;}
+
+   /*
+    * Read solution 'i' (0 .. "getCount()" - 1) into 'pieces'.
+    * Return false if it cannot be read.
+    */
+   bool read(long long i, std::vector<piecePlacement> &pieces);
+
+ private:
+   mappedFile file;
+   solutionFileInfo info;
+   long long count,
+             dataOffset;
+   int stride;
+};
+
+/*
+ * Finds the lines of a text solution file in any order (line 0 is the
+ * initial state, line 'i' solution 'i').  The file is mapped into memory
+ * and scanned for line breaks only as far as the furthest line asked
+ * for.  The line offsets found are saved in file "<fileName>.idx" (on
+ * "close", and as the scan goes on in a large file) and used by the
+ * next "open" if the solution file has not changed size, modification
+ * time or the checksum of its ends since.  The index is mapped into
+ * memory like the file, so neither need fit in memory.
+ *
+ * Index file (little endian): "BPIDX002", size, modification time and
+ * checksum (see "sampleChecksum") of solution file, bytes of it scanned
+ * and number of offsets (8 bytes each), then the offset of each line
+ * found.
+ */
+class textSolutionIndex {
+ public:
+   textSolutionIndex(void) {indexed = 0; scanned = 0; checksum = 0;}
+   ~textSolutionIndex(void) {close();}
+
+   /*
+    * Open text solution file 'fileName'.  Return false if it cannot
+    * be read.
+    */
+   bool open(const char *fileName);
+
+   /*
+    * Save index (if it has grown) and close file.
+    */
+   void close(void);
+   bool isOpen(void) const {return file.isOpen();}
+
+   /*
+    * Set 'text' and 'length' to line 'i' (without line break).
+    * Return false if there is no such line.
+    */
+   bool line(long long i, const char *&text, size_t &length);
+
+   /*
+    * Return number of lines in file (scanning all of it if necessary).
+    */
+   long long getLineCount(void);
+
+   /*
+    * Delete index of text solution file 'fileName' (before rewriting it).
+    */
+   static void discard(const char *fileName);
+
+ private:
+   long long getKnownLines(void) const {return (long long)(indexed + offsets.size());}
+   unsigned long long offset(long long i);
+   void scanTo(long long i);
+   bool load(void);
+   bool save(void);
+   unsigned long long sampleChecksum(void);
+
+   mappedFile file,
+              index; // offsets of lines 0 to "indexed" - 1, saved by earlier scans
+   std::string indexName;
+   unsigned long long indexed;
+   std::vector<unsigned long long> offsets; // start of each line found since, not yet saved
+   unsigned long long scanned,              // bytes of file scanned for line breaks
+                      checksum;             // see "sampleChecksum"
+};
+
+#endif
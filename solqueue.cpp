@@ -0,0 +1,102 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "solqueue.cpp" - Member functions of class "solutionQueue" (defined in "solqueue.h").           *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <chrono>
+#include <assert.h>
+
+#include "solqueue.h"
+
+#define WRITER_IDLE_MS 1 // milliseconds writer sleeps when queue is empty
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Constructor.
+ */
+solutionQueue::solutionQueue(void) {
+   slotSize  = 0;
+   head      = 0;
+   tail      = 0;
+   finishing = false;
+   fullCount = 0;
+}
+
+/*
+ * Destructor.
+ */
+solutionQueue::~solutionQueue(void) {
+   finish();
+}
+
+/*
+ * Start writer thread passing each solution pushed to 'write'.
+ */
+void solutionQueue::start(const writeFunction &write, const int maxPieces) {
+   finish();
+   if (maxPieces != slotSize || lengths.empty()) {
+      slotSize = maxPieces;
+      lengths.assign(SOLUTION_QUEUE_SIZE, 0);
+      pieces.assign(SOLUTION_QUEUE_SIZE * (size_t)(slotSize > 0 ? slotSize : 1), piecePlacement());
+   }
+   writeSolution = write;
+   head      = 0;
+   tail      = 0;
+   finishing = false;
+   fullCount = 0;
+   writer = std::thread(&solutionQueue::writerMain, this);
+}
+
+/*
+ * Queue solution 'pieces[0..n-1]', waiting if the queue is full.
+ */
+void solutionQueue::push(const piecePlacement *pieces, const int n) {
+   unsigned long t = tail.load(std::memory_order_relaxed);
+   if (t - head.load(std::memory_order_acquire) == SOLUTION_QUEUE_SIZE) {
+      ++fullCount;
+      while (t - head.load(std::memory_order_acquire) == SOLUTION_QUEUE_SIZE)
+        std::this_thread::yield();
+   }
+   assert(n <= slotSize);
+   size_t slot = t & (SOLUTION_QUEUE_SIZE - 1);
+   lengths[slot] = n;
+   for (int i = 0; i < n; ++i)
+     this->pieces[slot * slotSize + i] = pieces[i];
+   tail.store(t + 1, std::memory_order_release);
+}
+
+/*
+ * Wait until every solution queued has been written, then stop writer thread.
+ */
+void solutionQueue::finish(void) {
+   if (!writer.joinable())
+     return;
+   finishing = true;
+   writer.join();
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Writer thread.  Write every solution waiting, then sleep briefly
+ * while queue is empty, until "finish" is called and queue is empty.
+ */
+void solutionQueue::writerMain(void) {
+   unsigned long h = head.load(std::memory_order_relaxed);
+   for (;;) {
+      bool last = finishing; // read before 'tail' so nothing pushed before "finish" is missed
+      unsigned long t = tail.load(std::memory_order_acquire);
+      for (; h != t; ++h) {
+         size_t slot = h & (SOLUTION_QUEUE_SIZE - 1);
+         writeSolution(&pieces[slot * slotSize], lengths[slot]);
+         head.store(h + 1, std::memory_order_release);
+      }
+      if (last)
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_IDLE_MS));
+   }
+}
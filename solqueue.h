@@ -0,0 +1,77 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "solqueue.h" - Class "solutionQueue" definition.                                                *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef SOLQUEUE_H
+#define SOLQUEUE_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+
+#include "placement.h"
+
+#define SOLUTION_QUEUE_SIZE 4096 // solutions held waiting to be written (power of 2)
+
+/*
+ * Passes solutions from the search to a writer thread, so that the
+ * search never waits on formatting or disk.  Solutions are held in a
+ * fixed size ring buffer (SOLUTION_QUEUE_SIZE solutions of as many
+ * blocks as the block set has) shared without locks by one producer (the
+ * thread calling "push", ie. the thread running the search's observer)
+ * and the writer thread, which takes every solution waiting at once
+ * and hands each to the function given to "start".  Only when the
+ * buffer is full does "push" wait for the writer to catch up.
+ */
+class solutionQueue {
+ public:
+   typedef std::function<void(const piecePlacement *, int)> writeFunction;
+
+   solutionQueue(void);
+   ~solutionQueue(void);
+
+   /*
+    * Start writer thread passing each solution pushed to 'write'.
+    * Solutions have at most 'maxPieces' blocks.
+    */
+   void start(const writeFunction &write, int maxPieces);
+
+   /*
+    * Queue solution 'pieces[0..n-1]', waiting if the queue is full.
+    */
+   void push(const piecePlacement *pieces, int n);
+
+   /*
+    * Wait until every solution queued has been written, then stop
+    * writer thread.
+    */
+   void finish(void);
+
+   /*
+    * Return number of times "push" found queue full since "start".
+    */
+   long getFullCount(void) const {return fullCount;}
+
+ private:
+   solutionQueue(const solutionQueue &);            // not copyable
+   solutionQueue &operator=(const solutionQueue &);
+
+   void writerMain(void);
+
+   std::vector<int> lengths;            // number of blocks in each solution of ring
+   std::vector<piecePlacement> pieces;  // blocks of solution 'i' of ring from i * slotSize
+   int slotSize;
+   std::atomic<unsigned long> head, // number of solutions taken by writer
+                              tail; // number of solutions pushed
+   std::atomic<bool> finishing;
+   writeFunction writeSolution;
+   std::thread writer;
+   long fullCount;
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "stats.h" - Class "searchStats" definition.                                                     *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <ostream>
+#include <iomanip>
+#include <vector>
+
+/*
+ * Statistics collected by "backtrackSearch" when compiled with
+ * SEARCH_STATS defined (cmake -DBLOCK_PUZZLE_STATS=ON): nodes, fit tests
+ * and dead ends at each depth (number of blocks placed), and fit tests
+ * and dead ends for each block.  A dead end is a node at which no
+ * placement fits, counted against the depth and the block placed last.
+ *
+ * Without SEARCH_STATS every function is empty and inline, so the
+ * search costs nothing extra.
+ */
+#ifdef SEARCH_STATS
+
+class searchStats {
+ public:
+   static const bool enabled = true;
+
+   /*
+    * Clear statistics for a block set of 'nBlocks' blocks.
+    */
+   void reset(const int nBlocks) {
+      depths.assign(nBlocks + 1, counts());
+      blocks.assign(nBlocks, counts());
+   }
+
+   void node(const int depth)                     {++depths[depth].nodes;}
+   void test(const int depth, const int block)    {++depths[depth].tested; ++blocks[block].tested;}
+   void fit(const int depth, const int block)     {++depths[depth].fitted; ++blocks[block].fitted;}
+   void prune(const int depth, const int block)   {++depths[depth].pruned; ++blocks[block].pruned;}
+   void deadEnd(const int depth, const int lastBlock) {
+      ++depths[depth].deadEnds;
+      if (lastBlock >= 0)
+        ++blocks[lastBlock].deadEnds;
+   }
+
+   /*
+    * Add statistics of search 's' whose depth 0 was depth 'offset' of this one.
+    */
+   void merge(const searchStats &s, const int offset) {
+      int i;
+      for (i = 0; i < (int)s.depths.size() && i + offset < (int)depths.size(); ++i)
+        depths[i + offset].add(s.depths[i]);
+      for (i = 0; i < (int)s.blocks.size() && i < (int)blocks.size(); ++i)
+        blocks[i].add(s.blocks[i]);
+   }
+
+   /*
+    * Write statistics to 'out' as two tables (by depth and by block).
+    */
+   void report(std::ostream &out) const {
+      int i;
+      out << "depth        nodes       tested       fitted   fit%     pruned  dead ends\n";
+      for (i = 0; i < (int)depths.size(); ++i)
+        if (depths[i].nodes > 0)
+          line(out, i, depths[i], depths[i].nodes);
+      out << "\nblock                    tested       fitted   fit%     pruned  dead ends\n";
+      for (i = 0; i < (int)blocks.size(); ++i)
+        line(out, i, blocks[i], -1);
+   }
+
+ private:
+   struct counts {
+      counts(void) : nodes(0), tested(0), fitted(0), pruned(0), deadEnds(0) {}
+      void add(const counts &c) {
+         nodes    += c.nodes;
+         tested   += c.tested;
+         fitted   += c.fitted;
+         pruned   += c.pruned;
+         deadEnds += c.deadEnds;
+      }
+      long nodes,
+           tested,   // placements of unused blocks tested for fit
+           fitted,   // placements that fitted
+           pruned,   // fitted placements abandoned by dead region pruning
+           deadEnds; // nodes at which nothing fitted
+   };
+
+   static void line(std::ostream &out, const int i, const counts &c, const long nodes) {
+      double ratio = c.tested > 0 ? 100.0 * c.fitted / c.tested : 0;
+      out << std::setw(5) << i;
+      if (nodes >= 0)
+        out << std::setw(13) << nodes;
+      else
+        out << std::setw(13) << "";
+      out << std::setw(13) << c.tested
+          << std::setw(13) << c.fitted << std::setw(7) << std::fixed << std::setprecision(1)
+          << ratio << std::setw(11) << c.pruned << std::setw(11) << c.deadEnds << "\n";
+   }
+
+   std::vector<counts> depths,
+                       blocks;
+};
+
+#else
+
+class searchStats {
+ public:
+   static const bool enabled = false;
+
+   void reset(int) {}
+   void node(int) {}
+   void test(int, int) {}
+   void fit(int, int) {}
+   void prune(int, int) {}
+   void deadEnd(int, int) {}
+   void merge(const searchStats &, int) {}
+   void report(std::ostream &out) const {
+      out << "Search statistics not compiled in (define SEARCH_STATS).\n";
+   }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,207 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "symmetry.h" - Class template "symmetryBreaker" definition.                                     *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include <vector>
+#include <algorithm>
+
+#include "search.h"
+
+/*
+ * Map square (r, c) of a 'height' x 'width' grid to its image under
+ * symmetry 's' (0 = identity, 1 = rotate 180, 2 = flip vertically,
+ * 3 = flip horizontally, and for square grids only 4 = transpose,
+ * 5 = rotate 90 clockwise, 6 = rotate 90 anticlockwise, 7 = transpose
+ * about other diagonal).
+ */
+inline int symmetricSquare(const int s, const int r, const int c,
+                           const int height, const int width) {
+   switch (s) {
+    case 1:  return (height - 1 - r) * width + (width - 1 - c);
+    case 2:  return (height - 1 - r) * width + c;
+    case 3:  return r * width + (width - 1 - c);
+    case 4:  return c * width + r;
+    case 5:  return c * width + (height - 1 - r);
+    case 6:  return (width - 1 - c) * width + r;
+    case 7:  return (width - 1 - c) * width + (height - 1 - r);
+    default: return r * width + c;
+   }
+}
+
+/*
+ * Removes the puzzle grid's rotation/reflection symmetry from a search.
+ *
+ * Every symmetry of the grid that maps the occupied squares onto
+ * themselves maps each solution onto another solution, so a full search
+ * finds each distinct tiling up to 8 times (4 on rectangular grids).
+ * One unused block whose placements are never mapped onto themselves
+ * by such a symmetry is restricted to "canonical" placements (those
+ * with the smallest mask among their symmetric images), leaving exactly
+ * one solution from each set of symmetric solutions.
+ *
+ * Used as the observer of the search, it passes canonical solutions on
+ * to the real observer, or if 'expand' is set, each canonical solution
+ * followed by its symmetric images (blocks sorted by anchor square).
+ */
+template <int WORDS>
+class symmetryBreaker : public searchObserver {
+ public:
+   symmetryBreaker(const placementTable<WORDS> &t, const int h, const int w,
+                   searchObserver &o, const bool expandSolutions)
+     : full(t), height(h), width(w), observer(o), expand(expandSolutions) {
+      brokenBlock = -1;
+      symmetries.push_back(0);
+   }
+
+   /*
+    * Find the symmetries of the grid given the squares already
+    * 'occupied' and choose a block (not in 'usedBlocks') to restrict.
+    * Return false if there is no symmetry to break, in which case
+    * "getTable" returns the unrestricted table.
+    */
+   bool prepare(const bitboard<WORDS> &occupied, const blockMask usedBlocks) {
+      int nSymmetries = height == width ? 8 : 4,
+          s, i, j, o;
+
+      // symmetries mapping occupied squares onto themselves
+      symmetries.assign(1, 0);
+      for (s = 1; s < nSymmetries; ++s)
+        if (imageOf(occupied, s) == occupied)
+          symmetries.push_back(s);
+      brokenBlock = -1;
+      if (symmetries.size() == 1)
+        return false;
+
+      // index placements by block, orientation and anchor
+      int nBlocks = full.getBlockCount();
+      pieceIndex.assign(full.getCells() * nBlocks * 8, -1);
+      for (i = 0; i < full.getCount(); ++i)
+        pieceIndex[pieceKey(full[i].piece, nBlocks)] = i;
+      blocks = nBlocks;
+
+      // image of every placement under every symmetry (-1 if image covers
+      // a blocked square, only possible for placements overlapping 'occupied'):
+      // the placement of the same block anchored on the first square of
+      // the image with the same mask
+      bitboard<WORDS> mask, imageMask, other;
+      piecePlacement piece;
+      image.assign(symmetries.size(), std::vector<int>(full.getCount()));
+      for (i = 0; i < full.getCount(); ++i) {
+         full.getMask(full[i], mask);
+         image[0][i] = i;
+         for (j = 1; j < (int)symmetries.size(); ++j) {
+            imageMask = imageOf(mask, symmetries[j]);
+            piece.block  = full[i].piece.block;
+            piece.anchor = imageMask.firstSet();
+            image[j][i]  = -1;
+            for (o = 0; o < 8 && image[j][i] == -1; ++o) {
+               piece.orientation = o;
+               int k = pieceIndex[pieceKey(piece, nBlocks)];
+               if (k != -1) {
+                  full.getMask(full[k], other);
+                  if (other == imageMask)
+                    image[j][i] = k;
+               }
+            }
+         }
+      }
+
+      // choose largest unused block with no placement mapped onto itself
+      std::vector<bool> fixedPoint(nBlocks, false);
+      for (i = 0; i < full.getCount(); ++i)
+        for (j = 1; j < (int)symmetries.size(); ++j)
+          if (image[j][i] == i)
+            fixedPoint[full[i].piece.block] = true;
+      for (i = 0; i < nBlocks; ++i)
+        if (!((usedBlocks >> i) & 1) && !fixedPoint[i]
+            && (brokenBlock == -1 || full.getBlockSize(i) > full.getBlockSize(brokenBlock)))
+          brokenBlock = i;
+      if (brokenBlock == -1)
+        return false;
+
+      // keep canonical placements of chosen block, all placements of others
+      std::vector<bool> keep(full.getCount(), true);
+      for (i = 0; i < full.getCount(); ++i)
+        if (full[i].piece.block == brokenBlock) {
+           full.getMask(full[i], mask);
+           for (j = 1; j < (int)symmetries.size(); ++j)
+             if (image[j][i] != -1) {
+                full.getMask(full[image[j][i]], other);
+                if (other < mask)
+                  keep[i] = false;
+             }
+        }
+      reduced.filter(full, keep);
+      return true;
+   }
+
+   /*
+    * Table to search: "prepare"s restricted table if it succeeded.
+    */
+   const placementTable<WORDS> &getTable(void) const {
+      return brokenBlock == -1 ? full : reduced;
+   }
+
+   int getSymmetryCount(void) const {return (int)symmetries.size();}
+   int getBrokenBlock(void) const   {return brokenBlock;           }
+
+   bool solution(const piecePlacement *pieces, int n) {
+      if (!observer.solution(pieces, n))
+        return false;
+      if (!expand || brokenBlock == -1)
+        return true;
+      piecePlacement images[MAX_NUMBER_BLOCKS];
+      for (int j = 1; j < (int)symmetries.size(); ++j) {
+         for (int i = 0; i < n; ++i)
+           images[i] = full[image[j][pieceIndex[pieceKey(pieces[i], blocks)]]].piece;
+         std::sort(images, images + n, anchorLess);
+         if (!observer.solution(images, n))
+           return false;
+      }
+      return true;
+   }
+
+   bool solutionsCounted(long n) {return observer.solutionsCounted(n);}
+   bool poll(double percentSolved, long nodes) {return observer.poll(percentSolved, nodes);}
+
+ private:
+   static bool anchorLess(const piecePlacement &a, const piecePlacement &b) {
+      return a.anchor < b.anchor;
+   }
+
+   bitboard<WORDS> imageOf(bitboard<WORDS> b, const int s) const {
+      bitboard<WORDS> result;
+      result.clear();
+      while (!b.empty()) {
+         int i = b.firstSet();
+         result.set(symmetricSquare(s, i / width, i % width, height, width));
+         b.reset(i);
+      }
+      return result;
+   }
+
+   static int pieceKey(const piecePlacement &p, const int nBlocks) {
+      return (p.anchor * nBlocks + p.block) * 8 + p.orientation;
+   }
+
+   const placementTable<WORDS> &full;
+   placementTable<WORDS> reduced;
+   int height,
+       width,
+       blocks,
+       brokenBlock; // block restricted to canonical placements (-1 if none)
+   searchObserver &observer;
+   bool expand;
+   std::vector<int> symmetries;          // symmetries (see "symmetricSquare") of grid
+   std::vector<std::vector<int> > image; // image[j][i] = placement i under symmetries[j]
+   std::vector<int> pieceIndex;          // placement index by "pieceKey"
+};
+
+#endif
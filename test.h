@@ -0,0 +1,47 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "test.h" - Checks used by the test programs ("test_*.cpp").                                     *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+/*
+ * Number of checks failed so far.  Each test program returns it from
+ * "main" (through TEST_RESULT), so that ctest sees a failure.
+ */
+static int testFailures = 0;
+
+/*
+ * Report (but carry on after) a condition that does not hold.
+ */
+#define CHECK(cond)                                                           \
+   do {                                                                       \
+      if (!(cond)) {                                                          \
+         fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+         ++testFailures;                                                      \
+      }                                                                       \
+   } while (0)
+
+/*
+ * Report (but carry on after) values 'a' and 'b' (of integer type) that
+ * differ.
+ */
+#define CHECK_EQUAL(a, b)                                                     \
+   do {                                                                       \
+      long long x_ = (long long)(a), y_ = (long long)(b);                     \
+      if (x_ != y_) {                                                         \
+         fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n",    \
+                 __FILE__, __LINE__, #a, #b, x_, y_);                         \
+         ++testFailures;                                                      \
+      }                                                                       \
+   } while (0)
+
+#define TEST_RESULT (testFailures == 0 ? 0 : 1)
+
+#endif
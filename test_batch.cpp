@@ -0,0 +1,125 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "test_batch.cpp" - Tests of class "batchSolver" (see "batch.h").                                *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "batch.h"
+#include "test.h"
+
+/*
+ * A board that cannot be read must not leave a worker's puzzle believing
+ * it holds the default board: the next job on the default board would
+ * then be solved on the board of the job before the failed one.
+ */
+static void testFailedBoardLoad(const std::string &dataDir) {
+   std::string manifest = "test_batch_failed_board.jobs";
+   FILE *f = fopen(manifest.c_str(), "w");
+   CHECK(f != NULL);
+   if (f == NULL)
+     return;
+   // jobs run in order of block set then board, so these run as listed
+   fprintf(f, "; octagon board, then a missing board, then the default board\n");
+   fprintf(f, "j1 %s/block_set_2.blk %s/octagon_board.brd count-only limit=1\n",
+           dataDir.c_str(), dataDir.c_str());
+   fprintf(f, "j2 %s/block_set_3.blk %s/missing_board.brd count-only\n",
+           dataDir.c_str(), dataDir.c_str());
+   fprintf(f, "j3 %s/default_block_set.blk - count-only limit=2000\n", dataDir.c_str());
+   fclose(f);
+
+   batchSolver batch;
+   std::string error;
+   CHECK(batch.readManifest(manifest.c_str(), error));
+   batch.setWorkers(1);
+   batch.setOutputDir("test_batch_out");
+   CHECK_EQUAL(batch.run(), 1);
+
+   const std::vector<batchResult> &results = batch.getResults();
+   CHECK_EQUAL(results.size(), 3);
+   if (results.size() != 3)
+     return;
+   CHECK(results[0].ok);
+   CHECK(!results[1].ok);
+   CHECK(results[2].ok);
+   CHECK_EQUAL(results[2].solutions, 2000); // 8 x 8 board (octagon has only 1624)
+   CHECK(!results[2].complete);
+   remove(manifest.c_str());
+}
+
+/*
+ * Split CSV line 'line' into 'fields', unquoting quoted fields.
+ */
+static void splitCSV(const std::string &line, std::vector<std::string> &fields) {
+   fields.assign(1, "");
+   bool quoted = false;
+   for (size_t i = 0; i < line.size(); ++i) {
+      char ch = line[i];
+      if (quoted && ch == '"' && i + 1 < line.size() && line[i + 1] == '"')
+        fields.back() += line[++i];
+      else if (ch == '"')
+        quoted = !quoted;
+      else if (ch == ',' && !quoted)
+        fields.push_back("");
+      else
+        fields.back() += ch;
+   }
+}
+
+/*
+ * A failed job's error (block set errors contain commas) and a name
+ * with a quote in it each stay one field of the summary.
+ */
+static void testSummaryQuoting(void) {
+   FILE *f = fopen("test_batch_ragged.blk", "w");
+   CHECK(f != NULL);
+   if (f == NULL)
+     return;
+   fprintf(f, "255 0 0\n1112\n111\n");
+   fclose(f);
+   std::string manifest = "test_batch_summary.jobs";
+   f = fopen(manifest.c_str(), "w");
+   CHECK(f != NULL);
+   if (f == NULL)
+     return;
+   fprintf(f, "ragged\"job test_batch_ragged.blk - count-only\n");
+   fclose(f);
+
+   batchSolver batch;
+   std::string error;
+   CHECK(batch.readManifest(manifest.c_str(), error));
+   batch.setWorkers(1);
+   batch.setOutputDir("test_batch_out");
+   CHECK_EQUAL(batch.run(), 1);
+   const std::vector<batchResult> &results = batch.getResults();
+   CHECK_EQUAL(results.size(), 1);
+   if (results.size() != 1)
+     return;
+   CHECK(results[0].error.find(',') != std::string::npos);
+
+   std::ifstream summary("test_batch_out/" BATCH_SUMMARY);
+   std::string header, row;
+   CHECK(std::getline(summary, header) && std::getline(summary, row));
+   std::vector<std::string> fields;
+   splitCSV(row, fields);
+   CHECK_EQUAL(fields.size(), 8);
+   if (fields.size() == 8) {
+      CHECK(fields[0] == "ragged\"job");
+      CHECK(fields[1] == "failed");
+      CHECK(fields[7] == results[0].error);
+   }
+   remove(manifest.c_str());
+   remove("test_batch_ragged.blk");
+}
+
+int main(void) {
+   testFailedBoardLoad(BLOCK_PUZZLE_DATA_DIR);
+   testSummaryQuoting();
+   return TEST_RESULT;
+}
@@ -0,0 +1,110 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "test_daemon.cpp" - Tests of class "solverDaemon" (see "daemon.h").                             *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "daemon.h"
+#include "test.h"
+
+#define SOCKET_PATH "test_daemon.sock"
+
+/*
+ * Return socket connected to the daemon listening on SOCKET_PATH, or -1.
+ */
+static int connectToDaemon(void) {
+   sockaddr_un address;
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   strcpy(address.sun_path, SOCKET_PATH);
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd >= 0 && connect(fd, (sockaddr *)&address, sizeof(address)) != 0) {
+      close(fd);
+      fd = -1;
+   }
+   return fd;
+}
+
+/*
+ * Read from 'fd' until the daemon closes it (or 30 seconds pass), and
+ * set 'lines' to the lines received, sorted.  Return false on timeout.
+ */
+static bool readReplies(int fd, std::vector<std::string> &lines) {
+   std::string input;
+   char buffer[4096];
+   for (;;) {
+      pollfd p;
+      p.fd     = fd;
+      p.events = POLLIN;
+      if (poll(&p, 1, 30000) <= 0)
+        return false;
+      ssize_t n = read(fd, buffer, sizeof(buffer));
+      if (n <= 0)
+        break;
+      input.append(buffer, n);
+   }
+   lines.clear();
+   size_t start = 0, end;
+   while ((end = input.find('\n', start)) != std::string::npos) {
+      lines.push_back(input.substr(start, end - start));
+      start = end + 1;
+   }
+   std::sort(lines.begin(), lines.end());
+   return true;
+}
+
+/*
+ * A client that sends its requests then shuts down its side of the
+ * connection (as "echo ... | socat" does) still gets every answer, the
+ * last request even without a line break, and then the connection is
+ * closed.
+ */
+static void testHalfClosedClient(void) {
+   int fd = connectToDaemon();
+   CHECK(fd >= 0);
+   if (fd < 0)
+     return;
+   const char *requests = "1 count default_block_set.blk:octagon_board.brd 0\n"
+                          "2 count default_block_set.blk:octagon_board.brd 0\n"
+                          "3 count default_block_set.blk:octagon_board.brd 0";
+   CHECK_EQUAL(write(fd, requests, strlen(requests)), strlen(requests));
+   shutdown(fd, SHUT_WR);
+
+   std::vector<std::string> lines;
+   CHECK(readReplies(fd, lines));
+   close(fd);
+   CHECK_EQUAL(lines.size(), 3);
+   if (lines.size() == 3) {
+      CHECK(lines[0] == "1 ok 1624");
+      CHECK(lines[1] == "2 ok 1624");
+      CHECK(lines[2] == "3 ok 1624");
+   }
+}
+
+int main(void) {
+   solverDaemon daemon(BLOCK_PUZZLE_DATA_DIR);
+   daemon.setWorkers(2);
+   std::string error;
+   if (!daemon.listen(SOCKET_PATH, error)) {
+      fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+   }
+   std::thread server(&solverDaemon::serve, &daemon);
+   testHalfClosedClient();
+   daemon.stop();
+   server.join();
+   return TEST_RESULT;
+}
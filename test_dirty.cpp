@@ -0,0 +1,134 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "test_dirty.cpp" - Tests of class "dirtyGrid" (see "dirty.h").                                  *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <vector>
+
+#include "dirty.h"
+#include "test.h"
+
+#define RED   RGB(255, 0, 0)
+#define BLACK RGB(0, 0, 0)
+
+/*
+ * Check that rectangle 'd' is 'h' rows from row 'r' and 'w' columns from column 'c'.
+ */
+static void checkRect(const dirtyRect &d, int r, int c, int h, int w) {
+   CHECK_EQUAL(d.r, r);
+   CHECK_EQUAL(d.c, c);
+   CHECK_EQUAL(d.h, h);
+   CHECK_EQUAL(d.w, w);
+}
+
+/*
+ * Make 'g' an 'h' x 'w' grid shown all black.
+ */
+static void showBlack(dirtyGrid &g, int h, int w) {
+   std::vector<dirtyRect> rects;
+   g.resize(h, w);
+   for (int r = 0; r < h; ++r)
+     for (int c = 0; c < w; ++c)
+       g.set(r, c, BLACK);
+   g.flush(rects);
+}
+
+/*
+ * Nothing is shown after "resize", so the first flush covers every
+ * square drawn, even in the colour a square starts with.
+ */
+static void testFirstFlush(void) {
+   dirtyGrid g;
+   std::vector<dirtyRect> rects;
+   g.resize(2, 3);
+   for (int r = 0; r < 2; ++r)
+     for (int c = 0; c < 3; ++c)
+       g.set(r, c, BLACK);
+   CHECK(g.isDirty());
+   g.flush(rects);
+   CHECK(!g.isDirty());
+   CHECK_EQUAL(rects.size(), 1);
+   if (rects.size() == 1)
+     checkRect(rects[0], 0, 0, 2, 3);
+   g.flush(rects);
+   CHECK_EQUAL(rects.size(), 0);
+}
+
+/*
+ * Runs of the same columns in consecutive rows make one rectangle; a
+ * run of other columns below them starts another.
+ */
+static void testVerticalMerge(void) {
+   dirtyGrid g;
+   std::vector<dirtyRect> rects;
+   showBlack(g, 6, 6);
+   for (int r = 1; r <= 3; ++r) {
+      g.set(r, 3, RED); // out of order: rows are sorted by "flush"
+      g.set(r, 2, RED);
+   }
+   for (int c = 2; c <= 4; ++c)
+     g.set(4, c, RED);
+   g.flush(rects);
+   CHECK_EQUAL(rects.size(), 2);
+   if (rects.size() == 2) {
+      checkRect(rects[0], 1, 2, 3, 2);
+      checkRect(rects[1], 4, 2, 1, 3);
+   }
+}
+
+/*
+ * Squares next to each other in memory but on different rows are not
+ * one run.
+ */
+static void testRowEnd(void) {
+   dirtyGrid g;
+   std::vector<dirtyRect> rects;
+   showBlack(g, 3, 3);
+   g.set(0, 1, RED);
+   g.set(0, 2, RED);
+   g.set(1, 0, RED);
+   g.set(1, 1, RED);
+   g.flush(rects);
+   CHECK_EQUAL(rects.size(), 2);
+   if (rects.size() == 2) {
+      checkRect(rects[0], 0, 1, 1, 2);
+      checkRect(rects[1], 1, 0, 1, 2);
+   }
+}
+
+/*
+ * A square drawn again in the colour it is shown in (or changed and
+ * changed back before a flush) needs no drawing.
+ */
+static void testUnchanged(void) {
+   dirtyGrid g;
+   std::vector<dirtyRect> rects;
+   showBlack(g, 4, 4);
+   g.set(1, 1, BLACK);
+   g.set(2, 2, RED);
+   g.set(2, 2, BLACK);
+   CHECK(g.isDirty());
+   g.flush(rects);
+   CHECK(!g.isDirty());
+   CHECK_EQUAL(rects.size(), 0);
+   CHECK_EQUAL(g.get(2, 2), BLACK);
+
+   // and "invalidate" makes it need drawing again
+   g.invalidate();
+   g.set(2, 2, BLACK);
+   g.flush(rects);
+   CHECK_EQUAL(rects.size(), 1);
+   if (rects.size() == 1)
+     checkRect(rects[0], 2, 2, 1, 1);
+}
+
+int main(void) {
+   testFirstFlush();
+   testVerticalMerge();
+   testRowEnd();
+   testUnchanged();
+   return TEST_RESULT;
+}
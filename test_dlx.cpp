@@ -0,0 +1,124 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "test_dlx.cpp" - Tests of class "dlx" (see "dlx.h") against "backtrackSearch".                  *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "blockset.h"
+#include "dlx.h"
+#include "test.h"
+
+/*
+ * Keeps each solution found as text, blocks in the order reported.
+ */
+class solutionList : public searchObserver {
+ public:
+   bool solution(const piecePlacement *pieces, int n) {
+      std::string s;
+      char buffer[32];
+      for (int i = 0; i < n; ++i) {
+         sprintf(buffer, "%d.%d.%d ", pieces[i].block, pieces[i].orientation, pieces[i].anchor);
+         s += buffer;
+      }
+      found.push_back(s);
+      return true;
+   }
+   bool solutionsCounted(long) {return true;}
+   bool poll(double, long)     {return true;}
+
+   std::vector<std::string> found;
+};
+
+/*
+ * Block set of four blocks filling a 4 x 4 grid 48 ways.
+ */
+static const char SMALL_SET[] =
+   "255 0 0\n2111\n\n"
+   "0 255 0\n211\n100\n\n"
+   "0 0 255\n211\n001\n\n"
+   "9 9 9\n21\n11\n";
+
+/*
+ * The same with a second square block, so that not every block need be used.
+ */
+static const char SPARE_SET[] =
+   "255 0 0\n2111\n\n"
+   "0 255 0\n211\n100\n\n"
+   "0 0 255\n211\n001\n\n"
+   "9 9 9\n21\n11\n\n"
+   "99 99 99\n21\n11\n";
+
+/*
+ * Both engines find the same solutions, written the same way, though
+ * not in the same order.  Return number found.
+ */
+static long sameSolutions(blockSet &blocks) {
+   placementTable<1> table;
+   blocks.buildMasks(4);
+   table.build(blocks.data(), blocks.size(), 4, 4);
+   bitboard<1> empty;
+   empty.clear();
+
+   solutionList backtracked, covered;
+   backtrackSearch<1> b(table, backtracked);
+   CHECK(b.run(empty, 0));
+   dlx d(covered);
+   d.build(table, empty, 0);
+   CHECK(d.run());
+
+   CHECK_EQUAL(d.getSolutionCount(), (long)covered.found.size());
+   CHECK(covered.found != backtracked.found); // see "dlx.h"
+   std::sort(backtracked.found.begin(), backtracked.found.end());
+   std::sort(covered.found.begin(), covered.found.end());
+   CHECK(covered.found == backtracked.found);
+   return (long)covered.found.size();
+}
+
+/*
+ * A grid with no empty squares has no solutions (not one with no blocks).
+ */
+static void testFullGrid(blockSet &blocks) {
+   placementTable<1> table;
+   blocks.buildMasks(4);
+   table.build(blocks.data(), blocks.size(), 4, 4);
+   bitboard<1> full;
+   full.clear();
+   for (int i = 0; i < 16; ++i)
+     full.set(i);
+   blockMask used = ((blockMask)1 << blocks.size()) - 1;
+
+   solutionList backtracked, covered;
+   backtrackSearch<1> b(table, backtracked);
+   CHECK(b.run(full, used));
+   dlx d(covered);
+   d.build(table, full, used);
+   CHECK(d.run());
+   CHECK_EQUAL(backtracked.found.size(), 0);
+   CHECK_EQUAL(covered.found.size(), 0);
+   CHECK_EQUAL(d.getSolutionCount(), 0);
+}
+
+int main(void) {
+   blockSet blocks;
+   std::string error;
+   CHECK(parseBlockSet(SMALL_SET, sizeof(SMALL_SET) - 1, "small set", blocks, error));
+   if (blocks.size() == 0) {
+      fprintf(stderr, "%s\n", error.c_str());
+      return TEST_RESULT;
+   }
+   CHECK_EQUAL(sameSolutions(blocks), 48); // every block used: block columns primary
+   testFullGrid(blocks);
+
+   blockSet spare;
+   CHECK(parseBlockSet(SPARE_SET, sizeof(SPARE_SET) - 1, "spare set", spare, error));
+   if (spare.size() > 0)
+     CHECK(sameSolutions(spare) > 48); // block columns secondary
+   return TEST_RESULT;
+}
@@ -0,0 +1,128 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "test_framebuf.cpp" - Tests of class "frameBuffer" (see "framebuf.h").                          *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+#include <string>
+
+#include "framebuf.h"
+#include "test.h"
+
+#define RED   RGB(255, 0, 0)
+#define BLUE  RGB(0, 0, 255)
+#define BLACK RGB(0, 0, 0)
+
+/*
+ * Pixels inside a filled rectangle take its colour, those outside keep
+ * theirs; rectangles reaching outside the image are clipped to it.
+ */
+static void testFillRect(void) {
+   frameBuffer f;
+   f.resize(10, 8);
+   CHECK_EQUAL(f.getWidth(), 10);
+   CHECK_EQUAL(f.getHeight(), 8);
+   CHECK_EQUAL(f.getPixel(0, 0), BLACK);
+
+   f.fillRect(2, 3, 4, 2, RED);
+   CHECK_EQUAL(f.getPixel(2, 3), RED);
+   CHECK_EQUAL(f.getPixel(5, 4), RED);
+   CHECK_EQUAL(f.getPixel(1, 3), BLACK);
+   CHECK_EQUAL(f.getPixel(6, 3), BLACK);
+   CHECK_EQUAL(f.getPixel(2, 2), BLACK);
+   CHECK_EQUAL(f.getPixel(2, 5), BLACK);
+
+   f.fillRect(-3, -3, 5, 5, BLUE); // pixels 0 and 1 of rows 0 and 1
+   CHECK_EQUAL(f.getPixel(0, 0), BLUE);
+   CHECK_EQUAL(f.getPixel(1, 1), BLUE);
+   CHECK_EQUAL(f.getPixel(2, 1), BLACK);
+   CHECK_EQUAL(f.getPixel(1, 2), BLACK);
+
+   f.fillRect(8, 6, 10, 10, BLUE); // bottom right 2 x 2
+   CHECK_EQUAL(f.getPixel(9, 7), BLUE);
+   CHECK_EQUAL(f.getPixel(7, 7), BLACK);
+   CHECK_EQUAL(f.getPixel(10, 7), BLACK); // outside image
+
+   f.fillRect(20, 20, 5, 5, RED); // wholly outside: nothing drawn
+   f.fillRect(3, 3, 0, 5, BLUE);
+   CHECK_EQUAL(f.getPixel(3, 3), RED);
+
+   f.resize(4, 4);
+   CHECK_EQUAL(f.getPixel(0, 0), BLACK);
+}
+
+/*
+ * "present" counts calls and the pixels it would show, after clipping.
+ */
+static void testPresentCounts(void) {
+   frameBuffer f;
+   f.resize(10, 8);
+   f.present(0, 0, 3, 2);
+   f.present(8, 6, 5, 5); // 2 x 2 inside image
+   f.present(20, 0, 5, 5); // none inside image
+   CHECK_EQUAL(f.getPresentCount(), 3);
+   CHECK_EQUAL(f.getPresentedPixels(), 6 + 4);
+   f.resetCounts();
+   CHECK_EQUAL(f.getPresentCount(), 0);
+   CHECK_EQUAL(f.getPresentedPixels(), 0);
+   f.present(0, 0, 1, 1);
+   f.resize(10, 8);
+   CHECK_EQUAL(f.getPresentCount(), 0);
+}
+
+/*
+ * Last text drawn is kept; "resize" forgets it.
+ */
+static void testText(void) {
+   frameBuffer f;
+   f.resize(10, 8);
+   f.drawText(0, 0, "first", BLACK);
+   f.drawText(0, 0, "second", BLACK);
+   CHECK(f.getText() == "second");
+   f.resize(10, 8);
+   CHECK(f.getText().empty());
+}
+
+/*
+ * PPM is a header and 3 bytes per pixel, red first.
+ */
+static void testWritePPM(void) {
+   frameBuffer f;
+   f.resize(3, 2);
+   f.fillRect(1, 0, 1, 1, RGB(10, 20, 30));
+   const char *fileName = "test_framebuf.ppm";
+   CHECK(f.writePPM(fileName));
+
+   FILE *file = fopen(fileName, "rb");
+   CHECK(file != NULL);
+   if (file == NULL)
+     return;
+   std::string data;
+   char buffer[256];
+   size_t n;
+   while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+     data.append(buffer, n);
+   fclose(file);
+   remove(fileName);
+
+   std::string header = "P6\n3 2\n255\n";
+   CHECK_EQUAL(data.size(), header.size() + 3 * 2 * 3);
+   CHECK(data.compare(0, header.size(), header) == 0);
+   if (data.size() == header.size() + 3 * 2 * 3) {
+      CHECK_EQUAL((unsigned char)data[header.size() + 3], 10);
+      CHECK_EQUAL((unsigned char)data[header.size() + 4], 20);
+      CHECK_EQUAL((unsigned char)data[header.size() + 5], 30);
+      CHECK_EQUAL((unsigned char)data[header.size() + 6], 0);
+   }
+}
+
+int main(void) {
+   testFillRect();
+   testPresentCounts();
+   testText();
+   testWritePPM();
+   return TEST_RESULT;
+}
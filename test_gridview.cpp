@@ -0,0 +1,147 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "test_gridview.cpp" - Tests of class "gridView" (see "gridview.h") drawing into a               *
+*                       "frameBuffer".                                                            *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include "gridview.h"
+#include "framebuf.h"
+#include "test.h"
+
+#define RED   RGB(255, 0, 0)
+#define BLUE  RGB(0, 0, 255)
+#define BLACK RGB(0, 0, 0)
+
+#define SQUARE_PIXELS (SQUARE_SIZE * SQUARE_SIZE)
+
+/*
+ * Return colour of the middle pixel of square (r, c).
+ */
+static COLORREF squareColour(const frameBuffer &f, int r, int c) {
+   return f.getPixel(c * SQUARE_SIZE + SQUARE_SIZE / 2, r * SQUARE_SIZE + SQUARE_SIZE / 2);
+}
+
+/*
+ * Setting the grid size sizes the buffer to fit grid and text area,
+ * and fills the text area.
+ */
+static void testGridSize(void) {
+   frameBuffer f;
+   gridView v(&f);
+   v.setGridSize(3, 4);
+   CHECK_EQUAL(v.getPixelWidth(), 4 * SQUARE_SIZE);
+   CHECK_EQUAL(v.getPixelHeight(), 3 * SQUARE_SIZE + TEXT_AREA_HEIGHT);
+   CHECK_EQUAL(f.getWidth(), v.getPixelWidth());
+   CHECK_EQUAL(f.getHeight(), v.getPixelHeight());
+   CHECK_EQUAL(f.getPixel(0, 3 * SQUARE_SIZE), TEXT_AREA_COLOUR);
+   CHECK_EQUAL(f.getPresentCount(), 0);
+}
+
+/*
+ * A square drawn outside "beginDraw" / "endDraw" is shown at once;
+ * drawing it again in the colour shown does nothing.
+ */
+static void testUnbatched(void) {
+   frameBuffer f;
+   gridView v(&f);
+   v.setGridSize(3, 4);
+   v.drawSquare(RED, 1, 2);
+   CHECK_EQUAL(squareColour(f, 1, 2), RED);
+   CHECK_EQUAL(f.getPixel(2 * SQUARE_SIZE, SQUARE_SIZE), RED); // corners of square
+   CHECK_EQUAL(f.getPixel(3 * SQUARE_SIZE - 1, 2 * SQUARE_SIZE - 1), RED);
+   CHECK_EQUAL(f.getPixel(3 * SQUARE_SIZE, SQUARE_SIZE), BLACK);
+   CHECK_EQUAL(f.getPresentCount(), 1);
+   CHECK_EQUAL(f.getPresentedPixels(), SQUARE_PIXELS);
+
+   v.drawSquare(RED, 1, 2);
+   CHECK_EQUAL(f.getPresentCount(), 1);
+}
+
+/*
+ * Squares drawn in (nested) batches are shown together at the end of
+ * the outermost, one rectangle for a block's footprint.
+ */
+static void testBatched(void) {
+   frameBuffer f;
+   gridView v(&f);
+   v.setGridSize(4, 4);
+   v.beginDraw();
+   v.drawSquare(RED, 0, 1);
+   v.beginDraw();
+   v.drawSquare(RED, 1, 1);
+   v.endDraw();
+   CHECK_EQUAL(f.getPresentCount(), 0);
+   CHECK_EQUAL(squareColour(f, 0, 1), BLACK); // not drawn to back buffer yet
+   v.endDraw();
+   CHECK_EQUAL(squareColour(f, 0, 1), RED);
+   CHECK_EQUAL(squareColour(f, 1, 1), RED);
+   CHECK_EQUAL(f.getPresentCount(), 1);
+   CHECK_EQUAL(f.getPresentedPixels(), 2 * SQUARE_PIXELS);
+
+   // block moved one square right: only squares whose colour changed are shown
+   f.resetCounts();
+   v.beginDraw();
+   v.drawSquare(BLACK, 0, 1);
+   v.drawSquare(BLACK, 1, 1);
+   v.drawSquare(RED, 0, 1);
+   v.drawSquare(RED, 1, 1);
+   v.drawSquare(RED, 0, 2);
+   v.drawSquare(RED, 1, 2);
+   v.endDraw();
+   CHECK_EQUAL(f.getPresentCount(), 1);
+   CHECK_EQUAL(f.getPresentedPixels(), 2 * SQUARE_PIXELS);
+   CHECK_EQUAL(squareColour(f, 1, 2), RED);
+}
+
+/*
+ * "invalidate" makes every square drawn be shown again.
+ */
+static void testInvalidate(void) {
+   frameBuffer f;
+   gridView v(&f);
+   v.setGridSize(2, 2);
+   v.beginDraw();
+   for (int r = 0; r < 2; ++r)
+     for (int c = 0; c < 2; ++c)
+       v.drawSquare(BLUE, r, c);
+   v.endDraw();
+   f.resetCounts();
+
+   v.invalidate();
+   v.beginDraw();
+   for (int r = 0; r < 2; ++r)
+     for (int c = 0; c < 2; ++c)
+       v.drawSquare(BLUE, r, c);
+   v.endDraw();
+   CHECK_EQUAL(f.getPresentCount(), 1);
+   CHECK_EQUAL(f.getPresentedPixels(), 4 * SQUARE_PIXELS);
+}
+
+/*
+ * Text fills and shows the text area (batched like squares).
+ */
+static void testText(void) {
+   frameBuffer f;
+   gridView v(&f);
+   v.setGridSize(2, 3);
+   v.beginDraw();
+   v.drawText("hello");
+   CHECK_EQUAL(f.getPresentCount(), 0);
+   v.endDraw();
+   CHECK(f.getText() == "hello");
+   CHECK_EQUAL(f.getPresentCount(), 1);
+   CHECK_EQUAL(f.getPresentedPixels(), 3 * SQUARE_SIZE * TEXT_AREA_HEIGHT);
+   CHECK_EQUAL(f.getPixel(0, 2 * SQUARE_SIZE + TEXT_AREA_HEIGHT - 1), TEXT_AREA_COLOUR);
+}
+
+int main(void) {
+   testGridSize();
+   testUnbatched();
+   testBatched();
+   testInvalidate();
+   testText();
+   return TEST_RESULT;
+}
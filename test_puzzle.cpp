@@ -0,0 +1,37 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "test_puzzle.cpp" - Tests of class "puzzle" (see "puzzle.h").                                   *
+*                                                                                                 *
+*       Author  - Tom McDonnell                                                                   *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include "puzzle.h"
+#include "test.h"
+
+/*
+ * Solutions counted many at once from the transposition cache stop at
+ * the solution limit, not at the end of the cached count that passes it.
+ */
+static void testCacheCountLimit(const char *dataDir) {
+   static const long limits[] = {500, 1000, 1234, 1600};
+   puzzle puz;
+   CHECK(puz.readBoard((std::string(dataDir) + "/octagon_board.brd").c_str()));
+   CHECK(puz.readBlockSet((std::string(dataDir) + "/default_block_set.blk").c_str()));
+   puz.setThreads(1);
+   puz.setCountOnly(true);
+   puz.setCache(16 * 1024 * 1024, REPLACE_CHEAPEST);
+   for (int i = 0; i < (int)(sizeof(limits) / sizeof(limits[0])); ++i) {
+      puz.setSolutionLimit(limits[i]);
+      CHECK_EQUAL(puz.solve(), limits[i]);
+      CHECK(!puz.getCompleted());
+   }
+   puz.setSolutionLimit(0);
+   CHECK_EQUAL(puz.solve(), 1624);
+   CHECK(puz.getCompleted());
+}
+
+int main(void) {
+   testCacheCountLimit(BLOCK_PUZZLE_DATA_DIR);
+   return TEST_RESULT;
+}
@@ -0,0 +1,68 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "view.h" - Class "puzzleView" definition.                                                       *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef VIEW_H
+#define VIEW_H
+
+#include "colour.h"
+
+/*
+ * Everything "puzzle" needs from a user interface.  The puzzle itself
+ * is platform neutral; a front end (the Windows GUI in "winview.h", the
+ * command line solver in "block_puzzle_solve.cpp", or "gridView" with
+ * any "renderer") implements this and
+ * attaches it with "puzzle::setView".  A puzzle with no view draws
+ * nothing.
+ */
+class puzzleView {
+ public:
+   virtual ~puzzleView(void) {}
+
+   /*
+    * Called when a view is attached and whenever the puzzle grid
+    * changes size.
+    */
+   virtual void setGridSize(int height, int width) = 0;
+
+   /*
+    * Draw square (r, c) of the puzzle grid in 'colour' (black = empty).
+    */
+   virtual void drawSquare(COLORREF colour, int r, int c) = 0;
+
+   /*
+    * Called around a run of "drawSquare" calls (eg. the whole grid) so
+    * that the view may show them all at once when the run ends.
+    */
+   virtual void beginDraw(void) {}
+   virtual void endDraw(void)   {}
+
+   /*
+    * Called when what is shown may have been drawn over by someone else,
+    * so that the view does not skip squares drawn again in the colour it
+    * last showed.
+    */
+   virtual void invalidate(void) {}
+
+   /*
+    * Draw text in the status area (a single space clears it).
+    */
+   virtual void drawText(const char *text) = 0;
+
+   /*
+    * Show the report at the end of "puzzle::solve".
+    */
+   virtual void showMessage(const char *text) = 0;
+
+   /*
+    * Called periodically while solving so the user interface can handle
+    * input.  Return false if the application is closing.
+    */
+   virtual bool idle(void) = 0;
+};
+
+#endif
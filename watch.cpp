@@ -0,0 +1,248 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "watch.cpp" - Member functions of classes "snapshotPainter" and "searchWatcher", and search     *
+*               trace file functions (defined in "watch.h").                                      *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <stdio.h>
+
+#include "watch.h"
+
+#define TRACE_FORMAT "block_puzzle_trace 1" // first line of trace files
+
+using namespace std;
+
+/*
+ * Write " block.orientation.anchor" for each of 'pieces[0..n-1]', then
+ * end the line.
+ */
+static void writePieces(ostream &out, const piecePlacement *pieces, const int n) {
+   for (int i = 0; i < n; ++i)
+     out << " " << pieces[i].block << "." << pieces[i].orientation << "." << pieces[i].anchor;
+   out << "\n";
+}
+
+/*
+ * Read 'n' pieces written by "writePieces".
+ */
+static bool readPieces(istream &in, piecePlacement *pieces, const int n) {
+   char dot1, dot2;
+   for (int i = 0; i < n; ++i)
+     if (!(in >> pieces[i].block >> dot1 >> pieces[i].orientation >> dot2 >> pieces[i].anchor)
+         || dot1 != '.' || dot2 != '.')
+       return false;
+   return true;
+}
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Take shapes and colours of blocks, and colours of grid beneath them.
+ */
+void snapshotPainter::setup(block blocks[], const int n, const int h, const int w,
+                            const vector<COLORREF> &colours) {
+   int i, o, r, c;
+   height = h;
+   width  = w;
+   base   = colours;
+   frame  = colours;
+   shapes.assign(n, shape());
+   for (i = 0; i < n; ++i) {
+      block *bPtr = &blocks[i];
+      int oldOrientation = bPtr->getOrientation();
+      shapes[i].colour = bPtr->getColour();
+      for (o = 0; o < 8; ++o) {
+         bPtr->changeOrientation(o);
+         for (r = 0; r < bPtr->getHeight(); ++r)
+           for (c = 0; c < bPtr->getWidth(); ++c)
+             if (bPtr->getGrid(r, c)) {
+                pos q;
+                q.r = r;
+                q.c = c - bPtr->getTLcol();
+                shapes[i].squares[o].push_back(q);
+             }
+      }
+      bPtr->changeOrientation(oldOrientation);
+   }
+}
+
+/*
+ * Draw grid with blocks 'pieces[0..n-1]' placed on 'v'.
+ */
+void snapshotPainter::draw(puzzleView &v, const piecePlacement *pieces, const int n) {
+   int i, k, r, c;
+   frame = base;
+   for (i = 0; i < n; ++i) {
+      const piecePlacement &p = pieces[i];
+      if (p.block < 0 || p.block >= (int)shapes.size() || p.orientation < 0 || p.orientation > 7)
+        continue;
+      const vector<pos> &squares = shapes[p.block].squares[p.orientation];
+      for (k = 0; k < (int)squares.size(); ++k) {
+         r = p.anchor / width + squares[k].r;
+         c = p.anchor % width + squares[k].c;
+         if (r >= 0 && r < height && c >= 0 && c < width)
+           frame[r * width + c] = shapes[p.block].colour;
+      }
+   }
+   v.beginDraw();
+   for (r = 0; r < height; ++r)
+     for (c = 0; c < width; ++c)
+       v.drawSquare(frame[r * width + c], r, c);
+   v.endDraw();
+}
+
+/*
+ * Write first lines of a trace file, describing the search traced.
+ */
+bool writeTraceHeader(ostream &out, const solutionFileInfo &info) {
+   out << TRACE_FORMAT << "\n"
+       << info.height << " " << info.width << " " << info.blockCount << " "
+       << hex << info.hash << dec << "\n"
+       << info.initial.size();
+   writePieces(out, info.initial.empty() ? NULL : &info.initial[0], (int)info.initial.size());
+   return !out.fail();
+}
+
+/*
+ * Write line of a trace file for snapshot 's'.
+ */
+void writeTraceFrame(ostream &out, const searchSnapshot &s) {
+   char buffer[64];
+   sprintf(buffer, "%.6f %ld %d", s.seconds, s.nodes, s.depth);
+   out << buffer;
+   writePieces(out, s.pieces, s.depth);
+}
+
+/*
+ * Read first lines of a trace file.  Return false if it is not one.
+ */
+bool readTraceHeader(istream &in, solutionFileInfo &info) {
+   string format;
+   int n;
+   if (!getline(in, format) || format != TRACE_FORMAT)
+     return false;
+   if (!(in >> info.height >> info.width >> info.blockCount >> hex >> info.hash >> dec >> n)
+       || n < 0 || n > MAX_NUMBER_BLOCKS)
+     return false;
+   info.initial.resize(n);
+   return readPieces(in, info.initial.empty() ? NULL : &info.initial[0], n);
+}
+
+/*
+ * Read next line of a trace file into 's' (seconds, nodes, depth and
+ * pieces).  Return false at end of file or if the line is malformed.
+ */
+bool readTraceFrame(istream &in, searchSnapshot &s) {
+   if (!(in >> s.seconds >> s.nodes >> s.depth) || s.depth < 0 || s.depth > MAX_NUMBER_BLOCKS)
+     return false;
+   s.words = 0;
+   return readPieces(in, s.pieces, s.depth);
+}
+
+/*
+ * Constructor.
+ */
+searchWatcher::searchWatcher(void) {
+   view      = NULL;
+   stopping  = false;
+   redrawAll = false;
+   frames    = 0;
+   setRate(SNAPSHOT_RATE);
+}
+
+/*
+ * Destructor.
+ */
+searchWatcher::~searchWatcher(void) {
+   stop();
+}
+
+/*
+ * Publish and draw at most 'perSecond' snapshots a second.
+ */
+void searchWatcher::setRate(const double perSecond) {
+   mailbox.setRate(perSecond);
+   interval = chrono::duration_cast<chrono::steady_clock::duration>(
+                chrono::duration<double>(perSecond > 0 ? 1 / perSecond : 0));
+}
+
+/*
+ * Start render thread for a search from state 'info'.
+ */
+bool searchWatcher::start(const snapshotPainter &p, const solutionFileInfo &info) {
+   stop();
+   painter = p;
+   frames  = 0;
+   bool ok = true;
+   if (!traceFileName.empty()) {
+      trace.open(traceFileName.c_str());
+      if (!trace || !writeTraceHeader(trace, info)) {
+         trace.close();
+         ok = false;
+      }
+   }
+   if (view != NULL) {
+      view->setGridSize(painter.getHeight(), painter.getWidth());
+      view->invalidate();
+      redrawAll = false;
+   }
+   mailbox.reset();
+   stopping = false;
+   renderer = thread(&searchWatcher::renderMain, this);
+   return ok;
+}
+
+/*
+ * Draw last snapshot and stop render thread.
+ */
+void searchWatcher::stop(void) {
+   if (!renderer.joinable())
+     return;
+   {
+      lock_guard<mutex> guard(lock);
+      stopping = true;
+   }
+   stopped.notify_one();
+   renderer.join();
+   if (trace.is_open())
+     trace.close();
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Draw latest snapshot once per interval until stopped.
+ */
+void searchWatcher::renderMain(void) {
+   chrono::steady_clock::time_point next = chrono::steady_clock::now();
+   for (;;) {
+      next += interval;
+      {
+         unique_lock<mutex> guard(lock);
+         if (stopped.wait_until(guard, next, [this] {return stopping;}))
+           break;
+      }
+      drawLatest();
+   }
+   drawLatest(); // search has stopped: its last snapshot
+}
+
+/*
+ * Draw and trace latest snapshot, if there is a new one.
+ */
+void searchWatcher::drawLatest(void) {
+   const searchSnapshot *s = mailbox.take();
+   if (s == NULL)
+     return;
+   if (view != NULL) {
+      if (redrawAll.exchange(false))
+        view->invalidate();
+      painter.draw(*view, s->pieces, s->depth);
+   }
+   if (trace.is_open())
+     writeTraceFrame(trace, *s);
+   ++frames;
+}
@@ -0,0 +1,162 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "watch.h" - Classes "snapshotPainter" and "searchWatcher" definitions.                          *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+#include "view.h"
+#include "snapshot.h"
+#include "solfile.h"
+
+/*
+ * Draws snapshots of a search (or frames of a trace) on a view: the
+ * puzzle grid as it was when the search started with the blocks the
+ * search had placed drawn over it.  Keeps its own copy of the shape of
+ * every orientation of every block, so it may draw on one thread while
+ * the blocks are used on another.
+ */
+class snapshotPainter {
+ public:
+   snapshotPainter(void) {height = width = 0;}
+
+   /*
+    * Take shapes and colours of blocks 'blocks[0..n-1]' (each left in
+    * the orientation it was in), and 'colours' (row by row) as the
+    * colours of the 'height' x 'width' grid beneath them.
+    */
+   void setup(block blocks[], int n, int height, int width,
+              const std::vector<COLORREF> &colours);
+
+   /*
+    * Draw grid with blocks 'pieces[0..n-1]' placed on 'v', all at once
+    * (see "puzzleView::beginDraw").
+    */
+   void draw(puzzleView &v, const piecePlacement *pieces, int n);
+
+   int getHeight(void) const {return height;}
+   int getWidth(void) const  {return width; }
+
+ private:
+   struct shape {
+      COLORREF colour;
+      std::vector<pos> squares[8]; // of each orientation, relative to blocks TL square
+   };
+
+   std::vector<shape> shapes;
+   std::vector<COLORREF> base,  // grid before search
+                         frame; // grid drawn by "draw"
+   int height,
+       width;
+};
+
+/*
+ * Search trace files hold the snapshots drawn by a "searchWatcher", so
+ * that a search can be watched again afterwards at any speed (see
+ * "puzzle::replayTrace").  They are text: a line naming the format, a
+ * line giving the height and width of the grid, the number of blocks
+ * and the hash of the block set (as solution files, see "solfile.h"),
+ * a line giving the number of blocks in the puzzle before the search
+ * followed by each as "block.orientation.anchor", then one line per
+ * snapshot: seconds since the search started, nodes searched, number
+ * of blocks placed by the search and each of them as before.
+ */
+bool writeTraceHeader(std::ostream &out, const solutionFileInfo &info);
+void writeTraceFrame(std::ostream &out, const searchSnapshot &s);
+bool readTraceHeader(std::istream &in, solutionFileInfo &info);
+bool readTraceFrame(std::istream &in, searchSnapshot &s);
+
+/*
+ * Watches a search from a render thread of its own.  While a puzzle
+ * given the watcher solves (see "puzzle::setWatcher"), its search
+ * publishes snapshots to the watcher's "snapshotMailbox" at the rate
+ * set; the render thread takes the latest at the same rate and draws
+ * it on the view set (if any) and writes it to the trace file set (if
+ * any).  The search never waits on the render thread, and snapshots
+ * published faster than they are drawn are dropped.
+ */
+class searchWatcher {
+ public:
+   searchWatcher(void);
+   ~searchWatcher(void);
+
+   /*
+    * Draw snapshots on 'v' (NULL for none), from the render thread only
+    * while a search is watched.
+    */
+   void setView(puzzleView *v) {view = v;}
+
+   /*
+    * Publish and draw at most 'perSecond' snapshots a second (default
+    * SNAPSHOT_RATE).
+    */
+   void setRate(double perSecond);
+
+   /*
+    * Write snapshots drawn to trace file 'fileName' (empty for none),
+    * replaced at the start of each search watched.
+    */
+   void setTraceFile(const std::string &fileName) {traceFileName = fileName;}
+
+   /*
+    * Make the render thread redraw every square of its next snapshot
+    * (eg. after the window has been painted over).  May be called from
+    * any thread.
+    */
+   void refresh(void) {redrawAll = true;}
+
+   /*
+    * Return number of snapshots drawn in the last (or current) search.
+    */
+   long getFrameCount(void) const {return frames;}
+
+   /*
+    * Called by "puzzle::solve".  Start the render thread, drawing with
+    * 'p' a search from the state described by 'info'.  Return false if
+    * the trace file cannot be written (snapshots are still drawn).
+    */
+   bool start(const snapshotPainter &p, const solutionFileInfo &info);
+
+   /*
+    * Called by "puzzle::solve" once the search has stopped.  Draw the
+    * last snapshot published, then stop the render thread.
+    */
+   void stop(void);
+
+   snapshotMailbox &getMailbox(void) {return mailbox;}
+
+ private:
+   searchWatcher(const searchWatcher &);            // not copyable
+   searchWatcher &operator=(const searchWatcher &);
+
+   void renderMain(void);
+   void drawLatest(void);
+
+   snapshotMailbox mailbox;
+   snapshotPainter painter;
+   puzzleView *view;
+   std::string traceFileName;
+   std::ofstream trace;
+   std::chrono::steady_clock::duration interval; // between frames
+   std::thread renderer;
+   std::mutex lock; // guards 'stopping'
+   std::condition_variable stopped;
+   bool stopping;
+   std::atomic<bool> redrawAll;
+   std::atomic<long> frames;
+};
+
+#endif
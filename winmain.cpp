@@ -7,8 +7,11 @@
 \*************************************************************************************************/
 
 #include <windows.h>
+#include <mutex>
 
 #include "puzzle.h"
+#include "checker.h"
+#include "winview.h"
 
 #define WIN32_LEAN_AND_MEAN
 #define WINDOW_CLASS_NAME "WINCLASS1"
@@ -19,6 +22,12 @@ OPENFILENAME openBox; // common dialog box structure
 
 HWND main_window_handle = NULL;
 puzzle puz;
+winView view; // draws "puz" in main window
+searchWatcher watcher;   // draws searches of "puz" when watching (see "winproc.cpp")
+winView       watchView; // draws snapshots for "watcher" in main window, on its thread
+solvabilityChecker checker; // checks states of "puz" on background thread (see "winproc.cpp")
+checkResult        checked; // latest result of "checker", posted as WM_CHECK_RESULT
+std::mutex         checkedLock;
 
 int WINAPI WinMain(HINSTANCE hinstance,
                    HINSTANCE hprevinstance,
@@ -59,6 +68,12 @@ int WINAPI WinMain(HINSTANCE hinstance,
                     NULL);                     // creation parms
    if (main_window_handle == NULL)
      return(0);
+   view.setWindow(main_window_handle);
+   puz.setView(&view);
+   puz.setEstimateProgress(true); // time remaining shown in status bar while solving
+   watchView.setWindow(main_window_handle);
+   watcher.setView(&watchView);
+   watcher.setTraceFile(SEARCH_TRACE_FILE);
 
    // create open dialog box window structure
    char szFile[260]; // buffer for filename
@@ -77,15 +92,24 @@ int WINAPI WinMain(HINSTANCE hinstance,
    openBox.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
 
    // read default block set
-   if (!puz.readBlockSet("Default Block Set.blk")) {
-      MessageBox(main_window_handle,
-                 "File \"Default Block Set.blk\" not found.",
+   if (!puz.readBlockSet("default_block_set.blk")) {
+      MessageBox(main_window_handle, puz.getReadError().c_str(),
                  "Block Puzzle", MB_OK);
       // kill the application (should maybe send WM_DESTROY message somehow)
       PostQuitMessage(0);
       return (0);
    }
 
+   // check states of puzzle as blocks are added and removed
+   checker.setResultHandler([](const checkResult &r) {
+      {
+         std::lock_guard<std::mutex> guard(checkedLock);
+         checked = r;
+      }
+      PostMessage(main_window_handle, WM_CHECK_RESULT, 0, 0);
+   });
+   checker.load("default_block_set.blk", puz.getBoard());
+
    // enter main event loop (program is completely event driven)
    while (true) {
       if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
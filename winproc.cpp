@@ -7,19 +7,40 @@
 \*************************************************************************************************/
 
 #include <windows.h>
+#include <mutex>
 
 #include "menu.h"
 #include "puzzle.h"
+#include "checker.h"
+#include "winview.h"
 
 enum gameStates {HOLDING_BLOCK, NOT_HOLDING_BLOCK, SOLVING, VIEWING_SOLUTIONS};
 
-extern OPENFILENAME openBox; // defined in winmain.cpp
-extern puzzle       puz;     // defined in winmain.cpp
+extern OPENFILENAME openBox;            // defined in winmain.cpp
+extern HWND         main_window_handle; // defined in winmain.cpp
+extern puzzle       puz;                // defined in winmain.cpp
+extern winView      view;               // defined in winmain.cpp
+extern searchWatcher watcher;           // defined in winmain.cpp
+extern solvabilityChecker checker;      // defined in winmain.cpp
+extern checkResult  checked;            // defined in winmain.cpp
+extern std::mutex   checkedLock;        // defined in winmain.cpp
 
 static enum gameStates gameState;
 static pos             mousePos;  // mouse position in row, column format
 
 static int solutionNo = 0, solutionCount = 0; // used when viewing solutions
+static long checkVersion = 0; // state of puzzle last given to "checker"
+static bool watching = false; // searches drawn by "watcher" as they run
+
+/*
+ * Have "checker" find whether the blocks now in the puzzle can be
+ * completed (result arrives as WM_CHECK_RESULT).
+ */
+static void checkPuzzle(void) {
+   std::vector<piecePlacement> pieces;
+   puz.getPieces(pieces);
+   checkVersion = checker.update(pieces);
+}
 
 /*
  * Event handler of main window.
@@ -40,12 +61,34 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
       break;
     case WM_PAINT:
       hdc = BeginPaint(hwnd, &ps);
-      if (gameState != SOLVING)
-        puz.draw();
-      puz.drawText(""); // redraw last text message drawn
+      view.paint(hdc); // copy back buffer, holding everything drawn
+      if (gameState == SOLVING)
+        watcher.refresh(); // search being watched is drawn by watcher
 		EndPaint(hwnd, &ps);
 		return(0);
       break;
+    case WM_CHECK_RESULT:
+      // show whether puzzle can still be completed (unless result is stale)
+      if (gameState == HOLDING_BLOCK || gameState == NOT_HOLDING_BLOCK) {
+         checkResult r;
+         {
+            std::lock_guard<std::mutex> guard(checkedLock);
+            r = checked;
+         }
+         if (r.version == checkVersion) {
+            char buffer[64];
+            if (!r.solvable)
+              sprintf(buffer, "Cannot be completed.");
+            else if (r.counted)
+              sprintf(buffer, "Can be completed %ld way%s.", r.completions,
+                      r.completions == 1 ? "" : "s");
+            else
+              sprintf(buffer, "Can be completed (counting ways...)");
+            puz.drawText(buffer);
+         }
+      }
+      return(0);
+      break;
     case WM_MOUSEMOVE:
       if (gameState == HOLDING_BLOCK) {
          // if necessary, erase block and redraw in its new position
@@ -57,10 +100,12 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
              newMousePos.r >= 0 && newMousePos.r < puz.getHeight() &&
              newMousePos.c >= 0 && newMousePos.c < puz.getWidth()) {
             // mousePos has changed AND newMousePos is inside puzzle grid
+            puz.beginDraw();
             puz.eraseBlock(mousePos);
             // update mouse pos
             mousePos = newMousePos;
             puz.drawBlock(mousePos);
+            puz.endDraw();
          }
       }
       break;
@@ -74,7 +119,9 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
           // remove block from puzzle or pick up block
           assert(!puz.holdingBlock());
           puz.removeBlock(mousePos);
-          if (!puz.holdingBlock())
+          if (puz.holdingBlock())
+            checkPuzzle(); // block removed from puzzle
+          else
             puz.pickUpBlock();
           puz.drawBlock(mousePos);
           gameState = HOLDING_BLOCK;
@@ -83,6 +130,7 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
           // add block to puzzle or put down block
           assert(puz.holdingBlock());
           if (puz.addBlock(mousePos)) {
+             checkPuzzle();
              if (puz.solved())
                MessageBox(main_window_handle, 
                           "Congratulations - puzzle solved!",
@@ -112,13 +160,37 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
           break;
        }
        break; // end WM_LBUTTON_DOWN
+    case WM_KEYDOWN:
+      if (gameState == VIEWING_SOLUTIONS) {
+         // step backwards/forwards through solutions or jump to first/last
+         int newSolutionNo = solutionNo;
+         switch (wparam) {
+          case VK_LEFT:  newSolutionNo = solutionNo - 1; break;
+          case VK_RIGHT: newSolutionNo = solutionNo + 1; break;
+          case VK_PRIOR: newSolutionNo = solutionNo - 100; break;
+          case VK_NEXT:  newSolutionNo = solutionNo + 100; break;
+          case VK_HOME:  newSolutionNo = 1; break;
+          case VK_END:   newSolutionNo = solutionCount; break;
+         }
+         if (newSolutionNo < 1)
+           newSolutionNo = 1;
+         if (newSolutionNo > solutionCount)
+           newSolutionNo = solutionCount;
+         if (newSolutionNo != solutionNo) {
+            solutionNo = newSolutionNo;
+            puz.viewSolution(solutionNo);
+         }
+      }
+      break;
     case WM_MBUTTONDOWN:
       if (gameState == HOLDING_BLOCK) {
          // rotate block
          assert(puz.holdingBlock());
+         puz.beginDraw();
          puz.eraseBlock(mousePos);
          puz.rotateBlock();
          puz.drawBlock(mousePos);
+         puz.endDraw();
       }
       break;
     case WM_RBUTTONDOWN:
@@ -126,9 +198,11 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
        case HOLDING_BLOCK:
          // flip block
          assert(puz.holdingBlock());
+         puz.beginDraw();
          puz.eraseBlock(mousePos);
          puz.flipBlock();
          puz.drawBlock(mousePos);
+         puz.endDraw();
          break;
        case SOLVING:
          // halt solution process
@@ -160,10 +234,46 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
           puz.drawText("New Block Set Loaded.");
           gameState = NOT_HOLDING_BLOCK;
           break;
+*/
         case MENU_FILE_LOAD_NEW_PUZZLE_GRID:
-          // load new puzzle grid
+          // load new puzzle grid (see "board.h")
+          if (gameState == HOLDING_BLOCK) {
+             assert(puz.holdingBlock());
+             puz.eraseBlock(mousePos);
+             puz.putDownBlock();
+          }
+          gameState = NOT_HOLDING_BLOCK;
+          openBox.lpstrFilter = "Puzzle Grid\0*.BRD\0All\0*.*\0";
+          openBox.lpstrFile[0] = '\0';
+          if (GetOpenFileName(&openBox)) {
+             if (puz.readBoard(openBox.lpstrFile)) {
+                puz.drawText("New Puzzle Grid Loaded.");
+                checker.load("default_block_set.blk", puz.getBoard());
+                checkVersion = 0; // nothing in new grid to check
+             }
+             else
+               MessageBox(main_window_handle, "File is not a puzzle grid.",
+                          "Block Puzzle", MB_OK);
+          }
+          openBox.lpstrFilter = "Block Set\0*.BLK\0All\0*.*\0";
+          break;
+        case MENU_FILE_REPLAY_SEARCH:
+          // draw again the snapshots of the last search watched (right button stops)
+          if (gameState == HOLDING_BLOCK) {
+             assert(puz.holdingBlock());
+             puz.eraseBlock(mousePos);
+             puz.putDownBlock();
+          }
+          checker.cancel(); // no check while replaying
+          gameState = SOLVING;
+          if (puz.replayTrace(SEARCH_TRACE_FILE, 1) < 0)
+            MessageBox(main_window_handle,
+                       "No search of this puzzle has been watched\n"
+                       "(see 'Watch Search' in the 'Options' menu).",
+                       "Block Puzzle", MB_OK);
+          gameState = NOT_HOLDING_BLOCK;
+          checkPuzzle(); // puzzle is left as the search began
           break;
-*/
         case MENU_FILE_EXIT:
           // kill the application
 	 	    PostQuitMessage(0);
@@ -176,10 +286,18 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
              puz.eraseBlock(mousePos);
              puz.putDownBlock();
           }
+          checker.cancel(); // no check while solving
           puz.draw();
           gameState = SOLVING;
           solutionCount = puz.solve();
-          if (solutionCount > 0) {
+          if (watching) {
+             view.invalidate(); // window drawn on by watcher
+             puz.draw();
+          }
+          if (solutionCount < 0)
+            MessageBox(main_window_handle, "Cannot write file \"solution.dat\".",
+                       "Block Puzzle", MB_OK);
+          if (solutionCount > 0 && !puz.getCountOnly()) {
              solutionNo = 1;
              puz.viewSolution(solutionNo);
              gameState = VIEWING_SOLUTIONS;
@@ -187,6 +305,60 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
           else
             gameState = NOT_HOLDING_BLOCK;
           break;
+        case MENU_OPTIONS_EXACT_COVER:
+          // toggle between backtracking and exact cover (dancing links) solvers
+          if (puz.getEngine() == EXACT_COVER_ENGINE)
+            puz.setEngine(BACKTRACKING_ENGINE);
+          else
+            puz.setEngine(EXACT_COVER_ENGINE);
+          CheckMenuItem(GetMenu(hwnd), MENU_OPTIONS_EXACT_COVER,
+                        puz.getEngine() == EXACT_COVER_ENGINE ? MF_CHECKED : MF_UNCHECKED);
+          break;
+        case MENU_OPTIONS_PARALLEL:
+          // toggle between solving with one thread and one thread per processor
+          if (puz.getThreads() > 1)
+            puz.setThreads(1);
+          else
+            puz.setThreads(workStealingPool::hardwareThreads());
+          CheckMenuItem(GetMenu(hwnd), MENU_OPTIONS_PARALLEL,
+                        puz.getThreads() > 1 ? MF_CHECKED : MF_UNCHECKED);
+          break;
+        case MENU_OPTIONS_WATCH:
+          // toggle drawing the search as it runs (single threaded backtracking only)
+          watching = !watching;
+          puz.setWatcher(watching ? &watcher : NULL);
+          CheckMenuItem(GetMenu(hwnd), MENU_OPTIONS_WATCH, watching ? MF_CHECKED : MF_UNCHECKED);
+          break;
+        case MENU_OPTIONS_PRUNE:
+          // toggle abandoning placements that leave unfillable regions
+          puz.setPruning(!puz.getPruning());
+          CheckMenuItem(GetMenu(hwnd), MENU_OPTIONS_PRUNE,
+                        puz.getPruning() ? MF_CHECKED : MF_UNCHECKED);
+          break;
+        case MENU_OPTIONS_COUNT_ONLY:
+          // toggle counting solutions without saving them
+          puz.setCountOnly(!puz.getCountOnly());
+          CheckMenuItem(GetMenu(hwnd), MENU_OPTIONS_COUNT_ONLY,
+                        puz.getCountOnly() ? MF_CHECKED : MF_UNCHECKED);
+          break;
+        case MENU_OPTIONS_FIRST_ONLY:
+          // toggle stopping the solution process at the first solution
+          puz.setSolutionLimit(puz.getSolutionLimit() == 1 ? 0 : 1);
+          CheckMenuItem(GetMenu(hwnd), MENU_OPTIONS_FIRST_ONLY,
+                        puz.getSolutionLimit() == 1 ? MF_CHECKED : MF_UNCHECKED);
+          break;
+        case MENU_OPTIONS_BREAK_SYMMETRY:
+          // toggle searching for only one of each set of symmetric solutions
+          puz.setBreakSymmetry(!puz.getBreakSymmetry());
+          CheckMenuItem(GetMenu(hwnd), MENU_OPTIONS_BREAK_SYMMETRY,
+                        puz.getBreakSymmetry() ? MF_CHECKED : MF_UNCHECKED);
+          break;
+        case MENU_OPTIONS_EXPAND_SYMMETRY:
+          // toggle writing symmetric images of solutions found when skipping them
+          puz.setExpandSymmetry(!puz.getExpandSymmetry());
+          CheckMenuItem(GetMenu(hwnd), MENU_OPTIONS_EXPAND_SYMMETRY,
+                        puz.getExpandSymmetry() ? MF_CHECKED : MF_UNCHECKED);
+          break;
         case MENU_HELP_INSTRUCTIONS:
           MessageBox(main_window_handle,
                      "Use the left mouse button to pick up a block or\n"
@@ -196,6 +368,9 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
                      "block.\n\n"
                      "To put down a block, attempt to place it where it\n"
                      "will not fit.\n\n"
+                     "Each time a block is added or removed, the text\n"
+                     "area shows whether the puzzle can still be\n"
+                     "completed and in how many ways.\n\n"
                      "To solve the puzzle, select solve from the 'Options'\n"
                      "menu.\n"
                      "While the computer solves the puzzle, use the left\n"
@@ -204,9 +379,14 @@ LRESULT CALLBACK WindowProc(HWND   hwnd,
                      "the solution process.\n\n"
                      "While viewing solutions found by the computer, use\n"
                      "the left mouse button to view the next solution or\n"
-                     "the right mouse button to stop viewing solutions.\n\n"
-                     "The options 'Load New Block Set' and 'Load new Puzzle\n"
-                     "grid' in the 'File' menu are unavailable.\n",
+                     "the right mouse button to stop viewing solutions.\n"
+                     "The left and right arrow keys step backwards and\n"
+                     "forwards, page up/down step 100 solutions at a time\n"
+                     "and home/end show the first/last solution.\n\n"
+                     "The option 'Load New Block Set' in the 'File' menu is\n"
+                     "unavailable.  'Load New Puzzle Grid' reads a board\n"
+                     "file: one line per row, '.' for a square to fill,\n"
+                     "'#' for a blocked square and ' ' outside the board.\n",
                      "Block Puzzle - Instructions", MB_OK);
           break;
         case MENU_HELP_ABOUT:
@@ -0,0 +1,115 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "winrender.cpp" - Member functions of class "winRenderer" (defined in "winrender.h").           *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include <string.h>
+
+#include "winrender.h"
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Constructor.
+ */
+winRenderer::winRenderer(void) {
+   window    = NULL;
+   memoryDC  = NULL;
+   bitmap    = oldBitmap = NULL;
+   width     = height = 0;
+}
+
+/*
+ * Destructor.
+ */
+winRenderer::~winRenderer(void) {
+   freeBuffer();
+   for (std::map<COLORREF, HBRUSH>::iterator i = brushes.begin(); i != brushes.end(); ++i)
+     DeleteObject(i->second);
+}
+
+/*
+ * Make back buffer 'w' x 'h' pixels, cleared to black.
+ */
+void winRenderer::resize(int w, int h) {
+   freeBuffer();
+   width  = w;
+   height = h;
+   HDC hdc   = GetDC(window);
+   memoryDC  = CreateCompatibleDC(hdc);
+   bitmap    = CreateCompatibleBitmap(hdc, width, height);
+   oldBitmap = (HBITMAP)SelectObject(memoryDC, bitmap);
+   ReleaseDC(window, hdc);
+   SetBkMode(memoryDC, TRANSPARENT);
+   fillRect(0, 0, width, height, RGB(0, 0, 0));
+}
+
+/*
+ * Fill rectangle of back buffer with 'colour'.
+ */
+void winRenderer::fillRect(int x, int y, int w, int h, COLORREF colour) {
+   if (memoryDC == NULL)
+     return;
+   RECT rect = {x, y, x + w, y + h};
+   FillRect(memoryDC, &rect, brush(colour));
+}
+
+/*
+ * Write 'text' into back buffer.
+ */
+void winRenderer::drawText(int x, int y, const char *text, COLORREF colour) {
+   if (memoryDC == NULL)
+     return;
+   COLORREF oldColour = SetTextColor(memoryDC, colour);
+   TextOut(memoryDC, x, y, text, (int)strlen(text));
+   SetTextColor(memoryDC, oldColour);
+}
+
+/*
+ * Copy rectangle of back buffer to window.
+ */
+void winRenderer::present(int x, int y, int w, int h) {
+   if (memoryDC == NULL || window == NULL)
+     return;
+   HDC hdc = GetDC(window);
+   BitBlt(hdc, x, y, w, h, memoryDC, x, y, SRCCOPY);
+   ReleaseDC(window, hdc);
+}
+
+/*
+ * Copy whole back buffer to 'hdc'.
+ */
+void winRenderer::paint(HDC hdc) {
+   if (memoryDC != NULL)
+     BitBlt(hdc, 0, 0, width, height, memoryDC, 0, 0, SRCCOPY);
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Return brush of 'colour', making it if not made already.
+ */
+HBRUSH winRenderer::brush(COLORREF colour) {
+   std::map<COLORREF, HBRUSH>::iterator i = brushes.find(colour);
+   if (i != brushes.end())
+     return i->second;
+   HBRUSH b = CreateSolidBrush(colour);
+   brushes[colour] = b;
+   return b;
+}
+
+/*
+ * Free back buffer.
+ */
+void winRenderer::freeBuffer(void) {
+   if (memoryDC == NULL)
+     return;
+   SelectObject(memoryDC, oldBitmap);
+   DeleteObject(bitmap);
+   DeleteDC(memoryDC);
+   memoryDC  = NULL;
+   bitmap    = oldBitmap = NULL;
+}
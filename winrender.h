@@ -0,0 +1,57 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "winrender.h" - Class "winRenderer" definition.                                                 *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef WINRENDER_H
+#define WINRENDER_H
+
+#include <windows.h>
+#include <map>
+
+#include "renderer.h"
+
+/*
+ * Renderer drawing with GDI into a bitmap selected into a memory DC,
+ * copied to the client area of a window by "present" (one "BitBlt") and
+ * by "paint" on WM_PAINT.  A solid brush is made for each colour the
+ * first time it is used and kept until the renderer is destroyed, so
+ * drawing a square is a single "FillRect" (no pen is needed).
+ */
+class winRenderer : public renderer {
+ public:
+   winRenderer(void);
+   ~winRenderer(void);
+
+   void setWindow(HWND hwnd) {window = hwnd;}
+
+   void resize(int w, int h);
+   void fillRect(int x, int y, int w, int h, COLORREF colour);
+   void drawText(int x, int y, const char *text, COLORREF colour);
+   void present(int x, int y, int w, int h);
+
+   /*
+    * Copy the whole back buffer to 'hdc' (from "BeginPaint").
+    */
+   void paint(HDC hdc);
+
+ private:
+   winRenderer(const winRenderer &);            // not copyable
+   winRenderer &operator=(const winRenderer &);
+
+   HBRUSH brush(COLORREF colour);
+   void   freeBuffer(void);
+
+   HWND    window;
+   HDC     memoryDC;
+   HBITMAP bitmap,
+           oldBitmap; // selected into 'memoryDC' before 'bitmap'
+   int     width,
+           height;
+   std::map<COLORREF, HBRUSH> brushes;
+};
+
+#endif
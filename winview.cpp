@@ -0,0 +1,47 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "winview.cpp" - Member functions of class "winView" (defined in "winview.h").                   *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include "winview.h"
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Set size of puzzle grid, resizing window to fit.
+ */
+void winView::setGridSize(int h, int w) {
+   gridView::setGridSize(h, w);
+   if (window != NULL)
+     SetWindowPos(window, NULL, 0, 0,
+                  getPixelWidth() + 6,   // +6 allows for border
+                  getPixelHeight() + 49, // +49 title & menu
+                  SWP_NOMOVE | SWP_NOZORDER);
+}
+
+/*
+ * Show report at end of solve in a message box.
+ */
+void winView::showMessage(const char *text) {
+   MessageBox(window, text, "BlockPuzzle", MB_OK);
+}
+
+/*
+ * Handle Windows OS messages so that mouse movement etc. is not
+ * halted while solving and so that user may stop solution process.
+ * Return false if application is closing.
+ */
+bool winView::idle(void) {
+   MSG msg;
+   bool quit = false;
+   if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+      if (msg.message == WM_QUIT)
+        quit = true;
+      TranslateMessage(&msg); // translate any accelerator keys
+      DispatchMessage(&msg); // send the message to the window proc
+   }
+   return !quit;
+}
@@ -0,0 +1,45 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "winview.h" - Class "winView" definition.                                                       *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef WINVIEW_H
+#define WINVIEW_H
+
+#include <windows.h>
+
+#include "gridview.h"
+#include "winrender.h"
+
+#define WM_CHECK_RESULT (WM_APP + 1) // posted to main window by solvability checker (see "winmain.cpp")
+#define SEARCH_TRACE_FILE "search.trace" // written while watching a search, read to replay it
+
+/*
+ * Draws the puzzle in the client area of a window, double buffered
+ * through a "winRenderer" (see "gridView"), and shows messages in
+ * message boxes.
+ */
+class winView : public gridView {
+ public:
+   winView(void) {window = NULL; setRenderer(&screen);}
+
+   void setWindow(HWND hwnd) {window = hwnd; screen.setWindow(hwnd);}
+
+   /*
+    * Copy what has been drawn to 'hdc' (from "BeginPaint").
+    */
+   void paint(HDC hdc) {screen.paint(hdc);}
+
+   void setGridSize(int h, int w);
+   void showMessage(const char *text);
+   bool idle(void);
+
+ private:
+   HWND window;
+   winRenderer screen;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "workpool.cpp" - Member functions of class "workStealingPool" (defined in "workpool.h").        *
+*                                                                                                 *
+*     Author  - Tom McDonnell                                                                     *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#include "workpool.h"
+
+// PUBLIC FUNCTIONS ///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Constructor.
+ */
+workStealingPool::workStealingPool(int nThreads) {
+   if (nThreads < 1)
+     nThreads = 1;
+   for (int i = 0; i < nThreads; ++i)
+     queues.push_back(new taskQueue);
+   nextQueue = 0;
+   steals    = 0;
+}
+
+/*
+ * Destructor.
+ */
+workStealingPool::~workStealingPool(void) {
+   join();
+   for (int i = 0; i < (int)queues.size(); ++i)
+     delete queues[i];
+}
+
+/*
+ * Add a task.  All tasks must be added before "start".
+ */
+void workStealingPool::add(const std::function<void(void)> &task) {
+   queues[nextQueue]->tasks.push_back(task);
+   nextQueue = (nextQueue + 1) % queues.size();
+}
+
+/*
+ * Start the worker threads.
+ */
+void workStealingPool::start(void) {
+   for (int i = 0; i < (int)queues.size(); ++i)
+     threads.push_back(std::thread(&workStealingPool::workerMain, this, i));
+}
+
+/*
+ * Wait for all worker threads to finish.
+ */
+void workStealingPool::join(void) {
+   for (int i = 0; i < (int)threads.size(); ++i)
+     threads[i].join();
+   threads.clear();
+}
+
+/*
+ * Return number of threads the hardware can run at once (at least 1).
+ */
+int workStealingPool::hardwareThreads(void) {
+   int n = (int)std::thread::hardware_concurrency();
+   return n > 0 ? n : 1;
+}
+
+// PRIVATE FUNCTIONS //////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Take next task from front of own queue, or failing that from back
+ * of another thread's queue.  Return false if all queues are empty.
+ */
+bool workStealingPool::take(const int self, std::function<void(void)> &task) {
+   int n = (int)queues.size(), i;
+   {
+      std::lock_guard<std::mutex> guard(queues[self]->lock);
+      if (!queues[self]->tasks.empty()) {
+         task = queues[self]->tasks.front();
+         queues[self]->tasks.pop_front();
+         return true;
+      }
+   }
+   for (i = 1; i < n; ++i) {
+      taskQueue *victim = queues[(self + i) % n];
+      std::lock_guard<std::mutex> guard(victim->lock);
+      if (!victim->tasks.empty()) {
+         task = victim->tasks.back();
+         victim->tasks.pop_back();
+         ++steals;
+         return true;
+      }
+   }
+   return false;
+}
+
+/*
+ * Worker thread.  Run tasks until there are none left.
+ */
+void workStealingPool::workerMain(const int self) {
+   std::function<void(void)> task;
+   while (take(self, task))
+     task();
+}
@@ -0,0 +1,74 @@
+/*************************************************************************************************\
+*                                                                                                 *
+* "workpool.h" - Class "workStealingPool" definition.                                             *
+*                                                                                                 *
+*   Author  - Tom McDonnell                                                                       *
+*                                                                                                 *
+\*************************************************************************************************/
+
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+/*
+ * Fixed set of worker threads running a fixed set of tasks.
+ * Tasks are dealt round-robin to per-thread queues before the threads
+ * are started.  Each thread works through its own queue from the front
+ * (so tasks complete roughly in the order they were added) and when it
+ * runs out steals from the back of another thread's queue.  Threads exit
+ * when there is nothing left to steal.
+ */
+class workStealingPool {
+ public:
+   workStealingPool(int threads);
+   ~workStealingPool(void);
+
+   /*
+    * Add a task.  All tasks must be added before "start".
+    */
+   void add(const std::function<void(void)> &task);
+
+   /*
+    * Start the worker threads.
+    */
+   void start(void);
+
+   /*
+    * Wait for all worker threads to finish.
+    */
+   void join(void);
+
+   int getThreadCount(void) const {return (int)queues.size();}
+
+   /*
+    * Return number of tasks taken from another thread's queue.
+    */
+   long getStealCount(void) const {return steals;}
+
+   /*
+    * Return number of threads the hardware can run at once (at least 1).
+    */
+   static int hardwareThreads(void);
+
+ private:
+   struct taskQueue {
+      std::mutex lock;
+      std::deque<std::function<void(void)> > tasks;
+   };
+
+   bool take(int self, std::function<void(void)> &task);
+   void workerMain(int self);
+
+   std::vector<taskQueue *> queues;
+   std::vector<std::thread> threads;
+   std::atomic<long> steals;
+   int nextQueue; // queue next task is added to
+};
+
+#endif